@@ -0,0 +1,431 @@
+/**
+ * Copyright (C) 2023 Carnegie Mellon University
+ *
+ * This file is part of the Mixnet course project developed for
+ * the Computer Networks course (15-441/641) taught at Carnegie
+ * Mellon University.
+ *
+ * No part of the Mixnet project may be copied and/or distributed
+ * without the express permission of the 15-441/641 course staff.
+ */
+#include "common/benchmark.h"
+#include "common/json_writer.h"
+#include "testing/common/testing.h"
+
+#include "external/argparse/argparse.hpp"
+
+#include <algorithm>
+#include <assert.h>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <tuple>
+
+/**
+ * Control-plane benchmark. For every configuration in the sweep (topology,
+ * size, hello and reelection intervals, and root placement), starts the
+ * nodes and polls their reported state until the network converges (see
+ * orchestrator::is_converged()). Records the time at which every node's
+ * state last changed, along with the STP and LSA packets it sent and the
+ * number of path computations it ran (see mixnet_report_counters()), then
+ * writes per-configuration results and per-topology scaling curves (i.e.,
+ * metrics as a function of size) as JSON.
+ */
+class bench_controlplane final : public testcase {
+public:
+    // A single point in the sweep
+    struct config {
+        bench::topology_spec topology;          // Topology
+        uint16_t num_nodes;                     // Number of nodes
+        uint32_t hello_interval_ms;             // Root hello interval
+        uint32_t reelection_interval_ms;        // Reelection interval
+        std::string root_placement;             // Root placement name
+        uint16_t root_idx;                      // Node with the lowest address
+    };
+    // Results of a single run
+    struct result {
+        config cfg;                             // Configuration
+        bool is_ok = false;                     // Run completed?
+        bool is_converged = false;              // Converged before timeout?
+        double detection_ms = 0;                // Time to detect convergence
+        double convergence_ms = 0;              // Max over node convergence
+        uint64_t num_links = 0;                 // Links in the topology
+        uint16_t num_rooted = 0;                // Nodes agreeing on the root
+        uint16_t num_full_lsdb = 0;             // Nodes knowing every node
+        uint64_t stp_packets_sent = 0;          // Totals over all nodes
+        uint64_t lsa_packets_sent = 0;
+        uint64_t spf_runs = 0;
+    };
+
+private:
+    const config config_;
+    const uint32_t timeout_ms_;
+
+    // Measurements
+    bool is_converged_ = false;                 // Converged before timeout?
+    double detection_ms_ = 0;                   // Time to detect convergence
+    std::vector<orchestrator::node_state>       // Node -> State at detection
+                                states_{};      // (or timeout)
+
+public:
+    explicit bench_controlplane(const config& c, const uint32_t timeout_ms) :
+        testcase("bench_controlplane"), config_(c), timeout_ms_(timeout_ms) {}
+
+    virtual void pcap(const uint16_t, const mixnet_packet *const) override {}
+
+    virtual void setup() override {
+        graph_ = bench::build_topology(config_.topology, config_.num_nodes);
+        assert(graph_ != nullptr); // Validated when parsing the sweep
+
+        // The root is the node with the lowest address, so swap
+        // addresses with node 0 (which gets the lowest, i.e., 0).
+        std::vector<mixnet_address> mixaddrs(config_.num_nodes);
+        std::iota(mixaddrs.begin(), mixaddrs.end(), 0);
+        std::swap(mixaddrs[0], mixaddrs[config_.root_idx]);
+        graph_->set_mixaddrs(mixaddrs);
+
+        // Overrides the (autotest) defaults
+        root_hello_interval_ms_ = config_.hello_interval_ms;
+        reelection_interval_ms_ = config_.reelection_interval_ms;
+    }
+
+    virtual error_code run(orchestrator& o) override {
+        using clock = std::chrono::steady_clock;
+        const auto start = clock::now();
+        const auto deadline = (start + std::chrono::milliseconds(timeout_ms_));
+        const auto poll_interval = std::chrono::milliseconds(
+            std::max<uint32_t>(1, (config_.hello_interval_ms / 2)));
+
+        // Poll node states until the network converges
+        while (true) {
+            DIE_ON_ERROR(o.query_node_states(states_));
+            if (o.is_converged(states_)) { is_converged_ = true; break; }
+            if (clock::now() >= deadline) { break; }
+            std::this_thread::sleep_for(poll_interval);
+        }
+        detection_ms_ = std::chrono::duration<double, std::milli>(
+                                    clock::now() - start).count();
+        return error_code::NONE;
+    }
+
+    virtual void teardown() override { pass_teardown_ = true; }
+
+    // Writes this configuration's results (once the run completes),
+    // and returns a summary for the scaling curves.
+    result report(bench::json_writer& json, const bool is_ok,
+                  const bool per_node) const {
+        result r;
+        r.cfg = config_;
+        r.is_ok = is_ok;
+        r.is_converged = is_converged_;
+        r.detection_ms = detection_ms_;
+        for (const auto& neighbors : graph_->topology()) {
+            r.num_links += neighbors.size();
+        }
+        r.num_links /= 2;
+
+        std::vector<double> convergence_ms, stp, lsa, spf;
+        for (const auto& state : states_) {
+            convergence_ms.push_back(state.last_change_us / 1e3);
+            stp.push_back(state.stp_packets_sent);
+            lsa.push_back(state.lsa_packets_sent);
+            spf.push_back(state.spf_runs);
+
+            r.convergence_ms = std::max(r.convergence_ms,
+                                        (state.last_change_us / 1e3));
+            r.num_rooted += (state.root_address == 0);
+            r.num_full_lsdb += (state.lsdb_size >= config_.num_nodes);
+            r.stp_packets_sent += state.stp_packets_sent;
+            r.lsa_packets_sent += state.lsa_packets_sent;
+            r.spf_runs += state.spf_runs;
+        }
+        json.begin_object()
+            .field("topology", config_.topology.name)
+            .field("num_nodes", config_.num_nodes)
+            .field("num_links", r.num_links)
+            .field("hello_interval_ms", config_.hello_interval_ms)
+            .field("reelection_interval_ms", config_.reelection_interval_ms)
+            .field("root_placement", config_.root_placement)
+            .field("root_index", config_.root_idx)
+            .field("ok", is_ok)
+            .field("converged", is_converged_)
+            .field("detection_ms", detection_ms_)
+            .field("convergence_ms", r.convergence_ms)
+            .field("nodes_rooted", r.num_rooted)
+            .field("nodes_full_lsdb", r.num_full_lsdb)
+            .field("stp_packets_sent", r.stp_packets_sent)
+            .field("lsa_packets_sent", r.lsa_packets_sent)
+            .field("spf_runs", r.spf_runs);
+
+        json.key("per_node").begin_object();
+        bench::write_summary(json, "convergence_ms", convergence_ms);
+        bench::write_summary(json, "stp_packets_sent", stp);
+        bench::write_summary(json, "lsa_packets_sent", lsa);
+        bench::write_summary(json, "spf_runs", spf);
+        json.end_object();
+
+        if (per_node) {
+            json.key("nodes").begin_array();
+            for (uint16_t idx = 0; idx < states_.size(); idx++) {
+                const auto& state = states_[idx];
+                json.begin_object()
+                    .field("index", idx)
+                    .field("mixaddr", graph_->get_node(idx).mixaddr())
+                    .field("convergence_ms", (state.last_change_us / 1e3))
+                    .field("stp_packets_sent", state.stp_packets_sent)
+                    .field("lsa_packets_sent", state.lsa_packets_sent)
+                    .field("spf_runs", state.spf_runs)
+                    .end_object();
+            }
+            json.end_array();
+        }
+        json.end_object();
+        return r;
+    }
+};
+
+static void add_args(argparse::ArgumentParser& program) {
+    program.add_argument("--topologies")
+           .default_value(std::string("line,ring,star,mesh"))
+           .help("Comma-separated topologies (line, ring, star, mesh, "
+                 "grid, torus, fattree, er, ba, waxman, file:<path>)");
+    program.add_argument("--link-costs")
+           .default_value(std::string("1,1"))
+           .help("Range of (uniformly-drawn) link costs as MIN,MAX");
+    program.add_argument("--sizes")
+           .default_value(std::string("10,20,40"))
+           .help("Comma-separated topology sizes (in nodes), e.g., "
+                 "10,100,500,1000,2000");
+    program.add_argument("--hello-intervals")
+           .default_value(std::string("10"))
+           .help("Comma-separated root hello intervals (in ms)");
+    program.add_argument("--reelection-intervals")
+           .default_value(std::string("100"))
+           .help("Comma-separated reelection intervals (in ms)");
+    program.add_argument("--root-placements")
+           .default_value(std::string("first"))
+           .help("Comma-separated root placements (first, middle, last, "
+                 "random); e.g., 'first' is a line's end or a star's hub");
+    program.add_argument("--timeout-ms")
+           .default_value(10000)
+           .scan<'i', int>()
+           .help("Max time to await convergence per configuration");
+    program.add_argument("--seed")
+           .default_value(1)
+           .scan<'i', int>()
+           .help("PRNG seed for random root placement");
+    program.add_argument("--per-node")
+           .default_value(false)
+           .implicit_value(true)
+           .help("Also report every node's measurements");
+    program.add_argument("-o", "--output")
+           .default_value(std::string("bench_controlplane.json"))
+           .help("Path of the JSON report");
+}
+
+// Returns the root's index for the given placement (or -1 if unknown)
+static int root_index(const std::string& placement, const uint16_t
+                      num_nodes, std::mt19937& rng) {
+    if (placement == "first") { return 0; }
+    if (placement == "middle") { return (num_nodes / 2); }
+    if (placement == "last") { return (num_nodes - 1); }
+    if (placement == "random") {
+        return std::uniform_int_distribution<int>(0, (num_nodes - 1))(rng);
+    }
+    return -1;
+}
+
+// Expands the sweep described by the command-line arguments
+static bool parse_sweep(const argparse::ArgumentParser& program,
+                        std::vector<bench_controlplane::config>& configs) {
+    std::vector<uint64_t> sizes, hellos, reelections;
+    if (!bench::parse_uint_list("--sizes", program.get("--sizes"),
+                                2, UINT16_MAX, sizes) ||
+        !bench::parse_uint_list("--hello-intervals", program.get(
+            "--hello-intervals"), 1, UINT32_MAX, hellos) ||
+        !bench::parse_uint_list("--reelection-intervals", program.get(
+            "--reelection-intervals"), 1, UINT32_MAX, reelections)) {
+        return false;
+    }
+    const auto placements = bench::split_list(
+        program.get("--root-placements"));
+
+    const uint32_t seed = static_cast<uint32_t>(program.get<int>("--seed"));
+    graph::generator_params generator(seed);
+    if (!bench::parse_link_costs("--link-costs", program.get(
+        "--link-costs"), generator)) { return false; }
+
+    std::mt19937 rng(seed);
+    for (const auto& name : bench::split_list(
+                        program.get("--topologies"))) {
+        bench::topology_spec topology;
+        if (!bench::parse_topology(name, generator, topology)) {
+            std::cerr << "--topologies: invalid topology '"
+                      << name << "'" << std::endl;
+            return false;
+        }
+        for (const uint16_t size : bench::topology_sizes(topology, sizes)) {
+            for (const uint64_t hello : hellos) {
+                for (const uint64_t reelection : reelections) {
+                    if (reelection <= hello) {
+                        std::cerr << "Skipping reelection interval "
+                                  << reelection << " ms (must exceed the "
+                                  << hello << " ms hello)" << std::endl;
+                        continue;
+                    }
+                    for (const auto& placement : placements) {
+                        const int idx = root_index(placement, size, rng);
+                        if (idx < 0) {
+                            std::cerr << "--root-placements: unknown "
+                                      << "placement '" << placement
+                                      << "'" << std::endl;
+                            return false;
+                        }
+                        configs.push_back(bench_controlplane::config{
+                            topology, size,
+                            static_cast<uint32_t>(hello),
+                            static_cast<uint32_t>(reelection),
+                            placement, static_cast<uint16_t>(idx)});
+                    }
+                }
+            }
+        }
+    }
+    return !configs.empty();
+}
+
+// Writes metrics as a function of size for every other parameter
+// combination, and prints them as a table.
+static void write_curves(bench::json_writer& json, std::vector<
+                         bench_controlplane::result> results) {
+    typedef std::tuple<std::string, uint32_t, uint32_t, std::string> key;
+    std::map<key, std::vector<bench_controlplane::result>> curves;
+
+    std::stable_sort(results.begin(), results.end(), [] (
+        const bench_controlplane::result& a,
+        const bench_controlplane::result& b) {
+            return (a.cfg.num_nodes < b.cfg.num_nodes); });
+
+    for (const auto& r : results) {
+        curves[key(r.cfg.topology.name, r.cfg.hello_interval_ms,
+                   r.cfg.reelection_interval_ms,
+                   r.cfg.root_placement)].push_back(r);
+    }
+    auto write_array = [&json] (const std::string& name,
+        const std::vector<bench_controlplane::result>& points,
+        const std::function<double(const bench_controlplane::result&)>& f) {
+        json.key(name).begin_array();
+        for (const auto& point : points) { json.value(f(point)); }
+        json.end_array();
+    };
+    json.key("curves").begin_array();
+    for (const auto& [params, points] : curves) {
+        const auto& cfg = points.front().cfg;
+        json.begin_object()
+            .field("topology", cfg.topology.name)
+            .field("hello_interval_ms", cfg.hello_interval_ms)
+            .field("reelection_interval_ms", cfg.reelection_interval_ms)
+            .field("root_placement", cfg.root_placement);
+
+        write_array("num_nodes", points, [] (const auto& r) {
+            return r.cfg.num_nodes; });
+        write_array("convergence_ms", points, [] (const auto& r) {
+            return (r.is_converged ? r.convergence_ms : NAN); });
+        write_array("nodes_rooted", points, [] (const auto& r) {
+            return r.num_rooted; });
+        write_array("nodes_full_lsdb", points, [] (const auto& r) {
+            return r.num_full_lsdb; });
+        write_array("stp_packets_sent", points, [] (const auto& r) {
+            return r.stp_packets_sent; });
+        write_array("lsa_packets_sent", points, [] (const auto& r) {
+            return r.lsa_packets_sent; });
+        write_array("spf_runs", points, [] (const auto& r) {
+            return r.spf_runs; });
+        json.end_object();
+
+        // Also print the curve
+        std::cout << "[Bench] " << cfg.topology.name << " (hello="
+                  << cfg.hello_interval_ms << " ms, reelection="
+                  << cfg.reelection_interval_ms << " ms, root="
+                  << cfg.root_placement << ")" << std::endl
+                  << "[Bench]   nodes  converge_ms  rooted  full_lsdb"
+                  << "     stp_sent     lsa_sent     spf_runs" << std::endl;
+        for (const auto& r : points) {
+            std::cout << "[Bench] " << std::setw(7) << r.cfg.num_nodes
+                      << std::setw(13) << std::fixed << std::setprecision(1);
+            if (r.is_converged) { std::cout << r.convergence_ms; }
+            else { std::cout << "timeout"; }
+            std::cout << std::setw(8) << r.num_rooted
+                      << std::setw(11) << r.num_full_lsdb
+                      << std::setw(13) << r.stp_packets_sent
+                      << std::setw(13) << r.lsa_packets_sent
+                      << std::setw(13) << r.spf_runs << std::endl;
+        }
+    }
+    json.end_array();
+}
+
+static int run(const argparse::ArgumentParser& program,
+               orchestrator& orchestrator) {
+    std::vector<bench_controlplane::config> configs;
+    if (!parse_sweep(program, configs)) { return 1; }
+
+    const int timeout_ms = program.get<int>("--timeout-ms");
+    if (timeout_ms <= 0) {
+        std::cerr << "--timeout-ms must be positive" << std::endl;
+        return 1;
+    }
+    const auto output = program.get("--output");
+    std::ofstream file(output);
+    if (!file) {
+        std::cerr << "Failed to open " << output << std::endl;
+        return 1;
+    }
+    // Run the largest topologies first, so fragments are
+    // only ever shut down (never spawned) between runs.
+    std::stable_sort(configs.begin(), configs.end(), [] (
+        const bench_controlplane::config& a,
+        const bench_controlplane::config& b) {
+            return (a.num_nodes > b.num_nodes); });
+
+    bench::json_writer json(file);
+    json.begin_object().field("benchmark", "controlplane");
+    bench::write_host_info(json);
+    json.key("params").begin_object()
+        .field("timeout_ms", timeout_ms)
+        .field("seed", program.get<int>("--seed"))
+        .field("link_costs", program.get("--link-costs"))
+        .end_object();
+
+    size_t num_ok = 0;
+    std::vector<bench_controlplane::result> results;
+    json.key("results").begin_array();
+    for (const auto& config : configs) {
+        bench_controlplane tc(config, timeout_ms);
+        const bool is_ok = testcase::run_benchmark_case(tc, orchestrator);
+        results.push_back(tc.report(json, is_ok,
+                          (program["--per-node"] == true)));
+        num_ok += (is_ok && results.back().is_converged);
+        std::cout << std::endl;
+    }
+    json.end_array();
+    write_curves(json, results);
+    json.end_object();
+
+    std::cout << "[Bench] controlplane: " << num_ok << "/" << configs.size()
+              << " configurations converged, results in " << output
+              << std::endl;
+    return ((num_ok == configs.size()) ? 0 : 1);
+}
+
+int main(int argc, char **argv) {
+    return testcase::run_benchmark("bench_controlplane", argc,
+                                   argv, add_args, run);
+}
@@ -0,0 +1,382 @@
+/**
+ * Copyright (C) 2023 Carnegie Mellon University
+ *
+ * This file is part of the Mixnet course project developed for
+ * the Computer Networks course (15-441/641) taught at Carnegie
+ * Mellon University.
+ *
+ * No part of the Mixnet project may be copied and/or distributed
+ * without the express permission of the 15-441/641 course staff.
+ */
+#include "common/benchmark.h"
+#include "common/json_writer.h"
+#include "testing/common/testing.h"
+
+#include "external/argparse/argparse.hpp"
+#include "framework/latency.h"
+
+#include <assert.h>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string.h>
+#include <thread>
+
+/**
+ * Data-plane benchmark. For every configuration in the sweep (topology,
+ * size, packet type, per-node rate, and payload size), every node runs
+ * a traffic generator that sends to uniformly random destinations for
+ * the given duration, while the orchestrator injects tagged DATA probes
+ * (at random source-destination pairs, spread over the same period) to
+ * measure one-way latency under load. Deliveries of generated packets
+ * are counted at every node's user port. Results are written as JSON.
+ */
+class bench_dataplane final : public testcase {
+public:
+    // Constant parameters
+    static constexpr char PROBE_TAG[] = "probe:";
+
+    // A single point in the sweep
+    struct config {
+        bench::topology_spec topology;          // Topology
+        uint16_t num_nodes;                     // Number of nodes
+        mixnet_packet_type_t type;              // Generated packet type
+        uint32_t rate_pps;                      // Per-node rate (0: saturate)
+        uint16_t data_length;                   // Payload size (DATA only)
+    };
+    // Parameters shared by every configuration
+    struct params {
+        uint32_t duration_ms;                   // Generation period
+        uint32_t num_probes;                    // Latency probes per run
+        uint32_t convergence_timeout_ms;        // Max wait for convergence
+        uint32_t seed;                          // PRNG seed
+    };
+
+private:
+    const config config_;
+    const params params_;
+
+    // Measurements (pcap callbacks may run on multiple threads)
+    bool is_converged_ = false;                 // Converged before the load?
+    uint32_t num_probes_sent_ = 0;              // Latency probes injected
+    std::atomic<uint64_t> num_delivered_{0};    // Generated packets delivered
+    std::atomic<uint64_t> num_bytes_{0};        // Generated payload delivered
+    std::atomic<uint64_t> num_probes_{0};       // Probes delivered
+    latency_histogram latency_{};               // Probe latencies (in ns)
+
+    // Returns whether the given DATA payload belongs to a probe
+    static bool is_probe(const char *data, const size_t length) {
+        return ((length >= (sizeof(PROBE_TAG) - 1)) &&
+                (memcmp(data, PROBE_TAG, (sizeof(PROBE_TAG) - 1)) == 0));
+    }
+
+    // Returns a unique probe payload (at least data_length bytes)
+    std::string probe_data(const uint32_t seq) const {
+        std::string data = (PROBE_TAG + std::to_string(seq) + ":");
+        if (data.size() < config_.data_length) {
+            data.resize(config_.data_length, '.');
+        }
+        return data;
+    }
+
+public:
+    explicit bench_dataplane(const config& c, const params& p) :
+        testcase("bench_dataplane"), config_(c), params_(p) {}
+
+    virtual void pcap(
+        const uint16_t,
+        const mixnet_packet *const packet) override {
+        auto rh = reinterpret_cast<const
+            mixnet_packet_routing_header*>(packet->payload());
+
+        const size_t header_size = (
+            sizeof(mixnet_packet) + sizeof(mixnet_packet_routing_header) +
+            (rh->route_length * sizeof(mixnet_address)));
+
+        if (header_size > packet->total_size) { return; }
+        const char *data = (reinterpret_cast<const char*>(packet) +
+                            header_size);
+
+        const size_t length = (packet->total_size - header_size);
+        if (packet->type == PACKET_TYPE_DATA) {
+            if (is_probe(data, length)) { num_probes_++; return; }
+            num_bytes_ += length;
+            num_delivered_++;
+        }
+        // Only count requests (responses are generated by the node)
+        else if (packet->type == PACKET_TYPE_PING) {
+            auto ping = reinterpret_cast<const mixnet_packet_ping*>(data);
+            if ((length < sizeof(mixnet_packet_ping)) || ping->is_request) {
+                num_delivered_++;
+            }
+        }
+    }
+
+    virtual void setup() override {
+        graph_ = bench::build_topology(config_.topology, config_.num_nodes);
+        assert(graph_ != nullptr); // Validated when parsing the sweep
+
+        // Under load, drop captured packets rather than failing
+        pcap_queue_depth_ = 4096;
+        pcap_overflow_ = pcap_overflow::DROP_NEWEST;
+    }
+
+    virtual error_code run(orchestrator& o) override {
+        is_converged_ = o.await_convergence(params_.convergence_timeout_ms);
+
+        // Only capture the data plane
+        pcap_filter filter;
+        filter.type_mask = (pcap_filter::type_bit(PACKET_TYPE_DATA) |
+                            pcap_filter::type_bit(PACKET_TYPE_PING));
+        for (uint16_t i = 0; i < graph_->num_nodes; i++) {
+            DIE_ON_ERROR(o.pcap_change_subscription(i, true, filter));
+        }
+        // Start the load on every node
+        traffic_profile profile;
+        profile.type = config_.type;
+        profile.rate_pps = config_.rate_pps;
+        profile.duration_ms = params_.duration_ms;
+        profile.min_data_length = config_.data_length;
+        profile.max_data_length = config_.data_length;
+        for (uint16_t i = 0; i < graph_->num_nodes; i++) {
+            profile.seed = (params_.seed != 0) ? (params_.seed + i) : 0;
+            DIE_ON_ERROR(o.start_traffic(i, profile));
+        }
+        // Spread the probes evenly over the generation period
+        using clock = std::chrono::steady_clock;
+        const auto start = clock::now();
+        const auto end = (start + std::chrono::milliseconds(
+                          params_.duration_ms));
+
+        std::mt19937 rng(params_.seed);
+        std::uniform_int_distribution<uint16_t> pick(
+            0, (graph_->num_nodes - 1));
+
+        for (uint32_t seq = 0; seq < params_.num_probes; seq++) {
+            std::this_thread::sleep_until(start + ((end - start) *
+                                          seq / params_.num_probes));
+            const uint16_t src = pick(rng);
+            uint16_t dst = pick(rng);
+            while (dst == src) { dst = pick(rng); }
+
+            DIE_ON_ERROR(o.send_packet(src, dst, PACKET_TYPE_DATA,
+                                       probe_data(seq)));
+            num_probes_sent_++;
+        }
+        std::this_thread::sleep_until(end);
+        await_packet_propagation();
+
+        // Snapshot probe latencies (only probes are tracked)
+        for (const auto& [flow, histogram] : o.latency().histograms()) {
+            latency_.merge(histogram);
+        }
+        return error_code::NONE;
+    }
+
+    virtual void teardown() override { pass_teardown_ = true; }
+
+    // Writes this configuration's results (once the run completes)
+    void report(bench::json_writer& json, const bool is_ok) const {
+        framework::traffic_stats load; // Aggregate over fragments
+        double offered_pps = 0;
+        for (const auto& stats : traffic_stats()) {
+            load.num_sent += stats.num_sent;
+            load.num_drops += stats.num_drops;
+            offered_pps += stats.rate_pps();
+        }
+        const double duration_s = (params_.duration_ms / 1000.0);
+        // Only count observed deliveries: capture drops also include
+        // probes and PING responses, so if any occur (capture_drops is
+        // non-zero), the delivery metrics below are lower bounds.
+        const uint64_t num_delivered = num_delivered_;
+
+        json.begin_object()
+            .field("topology", config_.topology.name)
+            .field("num_nodes", config_.num_nodes)
+            .field("packet_type", (config_.type == PACKET_TYPE_DATA) ?
+                                  "data" : "ping")
+            .field("rate_pps", config_.rate_pps)
+            .field("data_length", config_.data_length)
+            .field("ok", is_ok)
+            .field("converged", is_converged_)
+            .field("sent", load.num_sent)
+            .field("generator_drops", load.num_drops)
+            .field("offered_pps", offered_pps)
+            .field("delivered", num_delivered)
+            .field("capture_drops", pcap_drop_count_)
+            .field("delivered_pps", (num_delivered / duration_s))
+            .field("goodput_bps", ((num_bytes_ * 8) / duration_s))
+            .field("delivery_ratio", (load.num_sent == 0) ? 0.0 :
+                   (static_cast<double>(num_delivered) / load.num_sent));
+
+        json.key("latency_us").begin_object()
+            .field("probes_sent", num_probes_sent_)
+            .field("probes_delivered", num_probes_.load())
+            .field("probes_matched", latency_.count())
+            .field("min", (latency_.min() / 1e3))
+            .field("mean", (latency_.mean() / 1e3))
+            .field("p50", (latency_.percentile(50) / 1e3))
+            .field("p99", (latency_.percentile(99) / 1e3))
+            .field("p999", (latency_.percentile(99.9) / 1e3))
+            .field("max", (latency_.max() / 1e3))
+            .end_object();
+
+        json.end_object();
+    }
+};
+
+static void add_args(argparse::ArgumentParser& program) {
+    program.add_argument("--topologies")
+           .default_value(std::string("line,ring,star,mesh"))
+           .help("Comma-separated topologies (line, ring, star, mesh, "
+                 "grid, torus, fattree, er, ba, waxman, file:<path>)");
+    program.add_argument("--link-costs")
+           .default_value(std::string("1,1"))
+           .help("Range of (uniformly-drawn) link costs as MIN,MAX");
+    program.add_argument("--sizes")
+           .default_value(std::string("4,8,16"))
+           .help("Comma-separated topology sizes (in nodes)");
+    program.add_argument("--types")
+           .default_value(std::string("data"))
+           .help("Comma-separated generated packet types (data, ping)");
+    program.add_argument("--rates")
+           .default_value(std::string("1000,0"))
+           .help("Comma-separated per-node rates in pps (0: saturate)");
+    program.add_argument("--data-lengths")
+           .default_value(std::string("64"))
+           .help("Comma-separated DATA payload sizes (in bytes)");
+    program.add_argument("--duration-ms")
+           .default_value(1000)
+           .scan<'i', int>()
+           .help("Traffic generation period per configuration");
+    program.add_argument("--probes")
+           .default_value(100)
+           .scan<'i', int>()
+           .help("Latency probes injected per configuration");
+    program.add_argument("--convergence-timeout-ms")
+           .default_value(5000)
+           .scan<'i', int>()
+           .help("Max time to await convergence before the load starts");
+    program.add_argument("--seed")
+           .default_value(1)
+           .scan<'i', int>()
+           .help("PRNG seed (0: random)");
+    program.add_argument("-o", "--output")
+           .default_value(std::string("bench_dataplane.json"))
+           .help("Path of the JSON report");
+}
+
+// Expands the sweep described by the command-line arguments
+static bool parse_sweep(const argparse::ArgumentParser& program,
+                        std::vector<bench_dataplane::config>& configs,
+                        bench_dataplane::params& params) {
+    std::vector<uint64_t> sizes, rates, data_lengths;
+    if (!bench::parse_uint_list("--sizes", program.get("--sizes"),
+                                2, UINT16_MAX, sizes) ||
+        !bench::parse_uint_list("--rates", program.get("--rates"),
+                                0, UINT32_MAX, rates) ||
+        !bench::parse_uint_list("--data-lengths", program.get(
+            "--data-lengths"), 0, MAX_MIXNET_DATA_SIZE,
+            data_lengths)) { return false; }
+
+    std::vector<mixnet_packet_type_t> types;
+    for (const auto& name : bench::split_list(program.get("--types"))) {
+        if (name == "data") { types.push_back(PACKET_TYPE_DATA); }
+        else if (name == "ping") { types.push_back(PACKET_TYPE_PING); }
+        else {
+            std::cerr << "--types: unknown packet type '"
+                      << name << "'" << std::endl;
+            return false;
+        }
+    }
+    const int duration_ms = program.get<int>("--duration-ms");
+    const int num_probes = program.get<int>("--probes");
+    const int timeout_ms = program.get<int>("--convergence-timeout-ms");
+    if ((duration_ms <= 0) || (num_probes < 0) || (timeout_ms < 0)) {
+        std::cerr << "--duration-ms must be positive; --probes and "
+                  << "--convergence-timeout-ms non-negative" << std::endl;
+        return false;
+    }
+    params.duration_ms = duration_ms;
+    params.num_probes = num_probes;
+    params.convergence_timeout_ms = timeout_ms;
+    params.seed = static_cast<uint32_t>(program.get<int>("--seed"));
+
+    graph::generator_params generator(params.seed);
+    if (!bench::parse_link_costs("--link-costs", program.get(
+        "--link-costs"), generator)) { return false; }
+
+    for (const auto& name : bench::split_list(
+                        program.get("--topologies"))) {
+        bench::topology_spec topology;
+        if (!bench::parse_topology(name, generator, topology)) {
+            std::cerr << "--topologies: invalid topology '"
+                      << name << "'" << std::endl;
+            return false;
+        }
+        for (const uint16_t size : bench::topology_sizes(topology, sizes)) {
+            for (const auto type : types) {
+                for (const uint64_t rate : rates) {
+                    for (const uint64_t length : data_lengths) {
+                        // Payload size only applies to DATA packets
+                        if ((type == PACKET_TYPE_PING) &&
+                            (length != data_lengths[0])) { continue; }
+
+                        configs.push_back(bench_dataplane::config{
+                            topology, size, type,
+                            static_cast<uint32_t>(rate),
+                            static_cast<uint16_t>(length)});
+                    }
+                }
+            }
+        }
+    }
+    return !configs.empty();
+}
+
+static int run(const argparse::ArgumentParser& program,
+               orchestrator& orchestrator) {
+    std::vector<bench_dataplane::config> configs;
+    bench_dataplane::params params;
+    if (!parse_sweep(program, configs, params)) { return 1; }
+
+    const auto output = program.get("--output");
+    std::ofstream file(output);
+    if (!file) {
+        std::cerr << "Failed to open " << output << std::endl;
+        return 1;
+    }
+    bench::json_writer json(file);
+    json.begin_object().field("benchmark", "dataplane");
+    bench::write_host_info(json);
+    json.key("params").begin_object()
+        .field("duration_ms", params.duration_ms)
+        .field("num_probes", params.num_probes)
+        .field("seed", params.seed)
+        .field("link_costs", program.get("--link-costs"))
+        .end_object();
+
+    size_t num_ok = 0;
+    json.key("results").begin_array();
+    for (const auto& config : configs) {
+        bench_dataplane tc(config, params);
+        const bool is_ok = testcase::run_benchmark_case(tc, orchestrator);
+        tc.report(json, is_ok);
+        num_ok += is_ok;
+        std::cout << std::endl;
+    }
+    json.end_array().end_object();
+
+    std::cout << "[Bench] dataplane: " << num_ok << "/" << configs.size()
+              << " configurations completed, results in " << output
+              << std::endl;
+    return ((num_ok == configs.size()) ? 0 : 1);
+}
+
+int main(int argc, char **argv) {
+    // Only track probe latencies (not the generated load)
+    return testcase::run_benchmark("bench_dataplane", argc, argv, add_args,
+                                   run, bench_dataplane::PROBE_TAG);
+}
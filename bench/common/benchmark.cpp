@@ -0,0 +1,196 @@
+/**
+ * Copyright (C) 2023 Carnegie Mellon University
+ *
+ * This file is part of the Mixnet course project developed for
+ * the Computer Networks course (15-441/641) taught at Carnegie
+ * Mellon University.
+ *
+ * No part of the Mixnet project may be copied and/or distributed
+ * without the express permission of the 15-441/641 course staff.
+ */
+#include "benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+
+namespace bench {
+
+std::vector<std::string> split_list(const std::string& list) {
+    std::vector<std::string> items;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) { items.push_back(item); }
+    }
+    return items;
+}
+
+bool parse_uint_list(const std::string& arg, const std::string& list,
+                     const uint64_t min, const uint64_t max,
+                     std::vector<uint64_t>& values) {
+    values.clear();
+    for (const auto& item : split_list(list)) {
+        size_t length = 0; uint64_t value = 0;
+        try { value = std::stoull(item, &length); }
+        catch (const std::exception&) { length = 0; }
+
+        if ((length != item.size()) || (item[0] == '-') ||
+            (value < min) || (value > max)) {
+            std::cerr << arg << ": expected integers in [" << min << ", "
+                      << max << "], got '" << item << "'" << std::endl;
+            return false;
+        }
+        values.push_back(value);
+    }
+    if (values.empty()) {
+        std::cerr << arg << ": expected a non-empty list" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool parse_topology(const std::string& name,
+                    const testing::graph::generator_params& params,
+                    topology_spec& spec) {
+    using testing::graph;
+    spec.name = name;
+    spec.params = params;
+    spec.path.clear();
+
+    // Edge-list file (loaded up-front to validate it)
+    const std::string file_prefix = "file:";
+    if (name.compare(0, file_prefix.size(), file_prefix) == 0) {
+        spec.path = name.substr(file_prefix.size());
+        auto g = graph::load_edge_list(spec.path);
+        if (g == nullptr) { return false; }
+        spec.file_num_nodes = g->num_nodes;
+        return true;
+    }
+    if (name == "line") { spec.type = graph::type::LINE; }
+    else if (name == "ring") { spec.type = graph::type::RING; }
+    else if (name == "star") { spec.type = graph::type::STAR; }
+    else if (name == "mesh") { spec.type = graph::type::FULL_MESH; }
+    else if (name == "grid") { spec.type = graph::type::GRID; }
+    else if (name == "torus") { spec.type = graph::type::TORUS; }
+    else if (name == "fattree") { spec.type = graph::type::FAT_TREE; }
+    else if (name == "er") { spec.type = graph::type::ERDOS_RENYI; }
+    else if (name == "ba") { spec.type = graph::type::BARABASI_ALBERT; }
+    else if (name == "waxman") { spec.type = graph::type::WAXMAN; }
+    else { return false; }
+    return true;
+}
+
+bool parse_link_costs(const std::string& arg, const std::string& list,
+                      testing::graph::generator_params& params) {
+    std::vector<uint64_t> costs;
+    if (!parse_uint_list(arg, list, 1, UINT16_MAX, costs)) { return false; }
+    if ((costs.size() != 2) || (costs[0] > costs[1])) {
+        std::cerr << arg << ": expected MIN,MAX" << std::endl;
+        return false;
+    }
+    params.min_cost = static_cast<uint16_t>(costs[0]);
+    params.max_cost = static_cast<uint16_t>(costs[1]);
+    return true;
+}
+
+// Returns why the topology is malformed with the given size (if it is)
+static const char *check_topology_size(const topology_spec& spec,
+                                       const uint16_t size) {
+    using testing::graph;
+    if (size < 2) { return "too small"; }
+    switch (spec.type) {
+    case graph::type::RING: {
+        if (size < 3) { return "too small"; }
+    } break;
+
+    case graph::type::TORUS: {
+        const uint16_t width = ((spec.params.grid_width != 0) ?
+            spec.params.grid_width : static_cast<uint16_t>(std::sqrt(size)));
+        if ((size % width) != 0) { return "not a full rectangle"; }
+    } break;
+
+    case graph::type::FAT_TREE: {
+        uint16_t k = 2;
+        const bool with_hosts = spec.params.fat_tree_hosts;
+        while (graph::fat_tree_size(k, with_hosts) < size) { k += 2; }
+        if (graph::fat_tree_size(k, with_hosts) != size) {
+            return "not a k-ary fat-tree size";
+        }
+    } break;
+
+    case graph::type::BARABASI_ALBERT: {
+        if (size <= spec.params.edges_per_node) { return "too small"; }
+    } break;
+
+    default: break;
+    } // switch
+    return nullptr;
+}
+
+std::vector<uint16_t> topology_sizes(const topology_spec& spec,
+                                     const std::vector<uint64_t>& sizes) {
+    if (!spec.path.empty()) { return {spec.file_num_nodes}; }
+
+    std::vector<uint16_t> valid;
+    for (const uint64_t size : sizes) {
+        const char *reason = check_topology_size(spec, size);
+        if (reason == nullptr) { valid.push_back(size); continue; }
+        std::cerr << "Skipping " << spec.name << " with " << size
+                  << " nodes (" << reason << ")" << std::endl;
+    }
+    return valid;
+}
+
+std::unique_ptr<testing::graph> build_topology(const topology_spec& spec,
+                                               const uint16_t num_nodes) {
+    if (!spec.path.empty()) {
+        return testing::graph::load_edge_list(spec.path);
+    }
+    auto g = std::make_unique<testing::graph>(num_nodes);
+    g->generate_topology(spec.type, spec.params);
+    return g;
+}
+
+void write_summary(json_writer& json, const std::string& name,
+                   std::vector<double> samples) {
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&samples] (const double p) {
+        if (samples.empty()) { return 0.0; }
+        const size_t rank = std::max<size_t>(1, static_cast<size_t>(
+            std::ceil((p / 100.0) * samples.size())));
+        return samples[rank - 1];
+    };
+    const double sum = std::accumulate(samples.begin(), samples.end(), 0.0);
+
+    json.key(name).begin_object()
+        .field("count", samples.size())
+        .field("min", percentile(0))
+        .field("mean", samples.empty() ? 0.0 : (sum / samples.size()))
+        .field("p50", percentile(50))
+        .field("p90", percentile(90))
+        .field("p99", percentile(99))
+        .field("max", percentile(100))
+        .end_object();
+}
+
+void write_host_info(json_writer& json) {
+    char hostname[256] = {};
+    gethostname(hostname, (sizeof(hostname) - 1));
+
+    const auto now = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    json.key("host").begin_object()
+        .field("hostname", hostname)
+        .field("num_cores", std::thread::hardware_concurrency())
+        .field("unix_time", static_cast<int64_t>(now))
+        .end_object();
+}
+
+} // namespace bench
@@ -0,0 +1,84 @@
+/**
+ * Copyright (C) 2023 Carnegie Mellon University
+ *
+ * This file is part of the Mixnet course project developed for
+ * the Computer Networks course (15-441/641) taught at Carnegie
+ * Mellon University.
+ *
+ * No part of the Mixnet project may be copied and/or distributed
+ * without the express permission of the 15-441/641 course staff.
+ */
+#ifndef BENCH_COMMON_BENCHMARK_H_
+#define BENCH_COMMON_BENCHMARK_H_
+
+#include "json_writer.h"
+#include "testing/common/graph.h"
+
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+/**
+ * Helpers shared by the benchmark drivers. Sweep parameters are given
+ * on the command-line as comma-separated lists (e.g., "4,8,16").
+ */
+// Splits a comma-separated list (empty items are skipped)
+std::vector<std::string> split_list(const std::string& list);
+
+// Parses a comma-separated list of unsigned integers, each in [min,
+// max]. On error, prints a message naming the argument and returns
+// false.
+bool parse_uint_list(const std::string& arg, const std::string& list,
+                     const uint64_t min, const uint64_t max,
+                     std::vector<uint64_t>& values);
+
+/**
+ * A topology in the sweep: either a generated one, or one loaded from an
+ * edge-list file (see graph::load_edge_list()), whose size is fixed.
+ */
+struct topology_spec {
+    std::string name;                           // As given (e.g., "ba")
+    testing::graph::type type;                  // Generated topology type
+    testing::graph::generator_params params;    // Generator parameters
+    std::string path;                           // Edge-list file (if any)
+    uint16_t file_num_nodes = 0;                // Edge-list file's node count
+};
+
+// Parses a topology name ("line", "ring", "star", "mesh", "grid", "torus",
+// "fattree", "er", "ba", "waxman", or "file:<path>"), generated with the
+// given parameters. Returns false for unknown names or unloadable files.
+bool parse_topology(const std::string& name,
+                    const testing::graph::generator_params& params,
+                    topology_spec& spec);
+
+// Parses a link cost range ("MIN,MAX") into the generator parameters.
+// On error, prints a message naming the argument and returns false.
+bool parse_link_costs(const std::string& arg, const std::string& list,
+                      testing::graph::generator_params& params);
+
+// Returns the sizes (among those given) for which the topology is well-
+// formed, printing the skipped ones. Edge-list files have a fixed size.
+std::vector<uint16_t> topology_sizes(const topology_spec& spec,
+                                     const std::vector<uint64_t>& sizes);
+
+// Instantiates the topology with the given number of nodes (which must
+// be one of its valid sizes). Returns nullptr if loading a file fails.
+std::unique_ptr<testing::graph> build_topology(const topology_spec& spec,
+                                               const uint16_t num_nodes);
+
+// Writes a summary of the given samples (count, min, mean, p50, p90,
+// p99, max) as an object under the given key. Percentiles use the
+// nearest-rank method; an empty sample set is written as zeros.
+void write_summary(json_writer& json, const std::string& name,
+                   std::vector<double> samples);
+
+// Writes the fields describing the host (e.g., core count) that every
+// benchmark report carries, so results are comparable across runs.
+void write_host_info(json_writer& json);
+
+} // namespace bench
+
+#endif // BENCH_COMMON_BENCHMARK_H_
@@ -0,0 +1,95 @@
+/**
+ * Copyright (C) 2023 Carnegie Mellon University
+ *
+ * This file is part of the Mixnet course project developed for
+ * the Computer Networks course (15-441/641) taught at Carnegie
+ * Mellon University.
+ *
+ * No part of the Mixnet project may be copied and/or distributed
+ * without the express permission of the 15-441/641 course staff.
+ */
+#include "json_writer.h"
+
+#include <assert.h>
+#include <cmath>
+#include <iomanip>
+#include <stdio.h>
+
+namespace bench {
+
+void json_writer::begin_item() {
+    if (after_key_) { after_key_ = false; return; }
+    if (!is_empty_.empty()) {
+        if (!is_empty_.back()) { os_ << ","; }
+        is_empty_.back() = false;
+        os_ << "\n" << std::string(2 * is_empty_.size(), ' ');
+    }
+}
+
+void json_writer::write_string(const std::string& str) {
+    os_ << '"';
+    for (const char c : str) {
+        switch (c) {
+        case '"': { os_ << "\\\""; } break;
+        case '\\': { os_ << "\\\\"; } break;
+        case '\n': { os_ << "\\n"; } break;
+        case '\t': { os_ << "\\t"; } break;
+        default: {
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char escaped[8];
+                snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                os_ << escaped;
+            }
+            else { os_ << c; }
+        } break;
+        } // switch
+    }
+    os_ << '"';
+}
+
+json_writer& json_writer::begin_scope(const char delimiter) {
+    begin_item();
+    os_ << delimiter;
+    is_empty_.push_back(true);
+    return *this;
+}
+
+json_writer& json_writer::end_scope(const char delimiter) {
+    assert(!is_empty_.empty() && !after_key_); // Sanity check
+    const bool is_empty = is_empty_.back();
+    is_empty_.pop_back();
+
+    if (!is_empty) { os_ << "\n" << std::string(2 * is_empty_.size(), ' '); }
+    os_ << delimiter;
+    if (is_empty_.empty()) { os_ << std::endl; }
+    return *this;
+}
+
+json_writer& json_writer::key(const std::string& name) {
+    begin_item();
+    write_string(name);
+    os_ << ": ";
+    after_key_ = true;
+    return *this;
+}
+
+json_writer& json_writer::value(const bool b) {
+    begin_item(); os_ << (b ? "true" : "false");
+    return *this;
+}
+
+json_writer& json_writer::value(const double d) {
+    begin_item();
+    if (!std::isfinite(d)) { os_ << "null"; return *this; }
+
+    const auto precision = os_.precision();
+    os_ << std::setprecision(10) << d << std::setprecision(precision);
+    return *this;
+}
+
+json_writer& json_writer::value(const std::string& str) {
+    begin_item(); write_string(str);
+    return *this;
+}
+
+} // namespace bench
@@ -0,0 +1,80 @@
+/**
+ * Copyright (C) 2023 Carnegie Mellon University
+ *
+ * This file is part of the Mixnet course project developed for
+ * the Computer Networks course (15-441/641) taught at Carnegie
+ * Mellon University.
+ *
+ * No part of the Mixnet project may be copied and/or distributed
+ * without the express permission of the 15-441/641 course staff.
+ */
+#ifndef BENCH_COMMON_JSON_WRITER_H_
+#define BENCH_COMMON_JSON_WRITER_H_
+
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace bench {
+
+// Helper macros
+#define DISALLOW_COPY_AND_ASSIGN(TypeName)                  \
+    TypeName(const TypeName&) = delete;                     \
+    void operator=(const TypeName&) = delete
+
+/**
+ * Minimal streaming JSON writer used to emit benchmark results. Values
+ * are written as they are supplied (pretty-printed, two-space indents);
+ * the caller is responsible for balancing objects and arrays, and for
+ * supplying a key before every value inside an object.
+ */
+class json_writer final {
+private:
+    std::ostream& os_;                                  // Output stream
+    std::vector<bool> is_empty_;                        // Scope -> No items yet?
+    bool after_key_ = false;                            // Key awaiting its value?
+
+    void begin_item();
+    void write_string(const std::string& str);
+    json_writer& begin_scope(const char delimiter);
+    json_writer& end_scope(const char delimiter);
+
+public:
+    DISALLOW_COPY_AND_ASSIGN(json_writer);
+    explicit json_writer(std::ostream& os) : os_(os) {}
+
+    // Objects and arrays
+    json_writer& begin_object() { return begin_scope('{'); }
+    json_writer& end_object() { return end_scope('}'); }
+    json_writer& begin_array() { return begin_scope('['); }
+    json_writer& end_array() { return end_scope(']'); }
+
+    // Object keys
+    json_writer& key(const std::string& name);
+
+    // Values (non-finite numbers are written as null)
+    json_writer& value(const bool b);
+    json_writer& value(const double d);
+    json_writer& value(const char *str) { return value(std::string(str)); }
+    json_writer& value(const std::string& str);
+
+    template<typename T, typename = std::enable_if_t<
+        std::is_integral_v<T> && !std::is_same_v<T, bool>>>
+    json_writer& value(const T v) {
+        begin_item(); os_ << +v; return *this;
+    }
+
+    // Shorthand for key(name).value(v)
+    template<typename T>
+    json_writer& field(const std::string& name, const T& v) {
+        return key(name).value(v);
+    }
+};
+
+// Cleanup
+#undef DISALLOW_COPY_AND_ASSIGN
+
+} // namespace bench
+
+#endif // BENCH_COMMON_JSON_WRITER_H_
@@ -10,6 +10,7 @@
  */
 #include "fragment.h"
 
+#include "validation.h"
 #include "mixnet/connection.h"
 #include "mixnet/node.h"
 #include "mixnet/packet.h"
@@ -19,7 +20,9 @@
 #include <cstring>
 #include <exception>
 #include <iostream>
+#include <signal.h>
 #include <stdlib.h>
+#include <sys/types.h>
 #include <unistd.h>
 
 namespace framework {
@@ -35,15 +38,35 @@ typedef high_resolution_clock clock;
     error_code = x;                                             \
     if (error_code != error_code::NONE) { return error_code; }
 
+/**
+ * Returns the ID of a local (AF_UNIX) link endpoint of this fragment.
+ * Index 0 denotes the node's server; (NID + 1) the client for NID.
+ */
+static sockaddr_in local_netaddr(const uint16_t idx) {
+    sockaddr_in id{};
+    id.sin_family = AF_INET;
+    id.sin_port = htons(static_cast<uint16_t>(idx + 1));
+    id.sin_addr.s_addr = htonl(static_cast<uint32_t>(getpid()));
+    return id;
+}
+
 fragment::node_context::
-node_context(message_queue& mq_pcap,
-             message_queue& mq_user) :
-             mq_pcap(mq_pcap), mq_user(mq_user) {
+node_context(packet_channel& mq_pcap,
+             packet_channel& mq_user,
+             packet_channel& mq_traffic) :
+             mq_pcap(mq_pcap), mq_user(mq_user),
+             mq_traffic(mq_traffic) {
     recv_buffer = std::make_unique<
         char[]>(MAX_MIXNET_PACKET_SIZE);
 }
 
 fragment::node_context::~node_context() {
+    for (mixnet_packet *packet : pcap_backlog) { free(packet); }
+
+    // Tear down the I/O backends before the FDs they reference
+    uring.reset();
+    io.reset();
+
     // Close local TX sockets to neighbors
     for (size_t nid = 0; nid < tx_socket_fds.size(); nid++) {
         if (tx_socket_fds[nid] != -1) { close(tx_socket_fds[nid]); }
@@ -65,6 +88,11 @@ error_code fragment::node_context::_send_blocking(
                   sizeof(mixnet_packet::total_size));
 
     networking::config c{networking::mode::RX_TX_BLOCKING, 0};
+    if (transport == networking::transport::UNIX_SEQPACKET) {
+        return networking::send_datagram<uint16_t>(
+            c, fd, b, error_code::MIXNET_CONNECTION_BROKEN,
+            MIN_MIXNET_PACKET_SIZE, MAX_MIXNET_PACKET_SIZE);
+    }
     return networking::send_generic<uint16_t>(
         c, fd, b, error_code::MIXNET_CONNECTION_BROKEN,
         MIN_MIXNET_PACKET_SIZE, MAX_MIXNET_PACKET_SIZE);
@@ -77,105 +105,141 @@ error_code fragment::node_context::_recv_once(
                   sizeof(mixnet_packet::total_size));
 
     networking::config c{networking::mode::RX_TRY_ONCE, 0};
+    if (transport == networking::transport::UNIX_SEQPACKET) {
+        return networking::recv_datagram<uint16_t>(
+            c, fd, b, error_code::MIXNET_CONNECTION_BROKEN,
+            MIN_MIXNET_PACKET_SIZE, MAX_MIXNET_PACKET_SIZE);
+    }
     return networking::recv_generic<uint16_t>(
         c, fd, b, error_code::MIXNET_CONNECTION_BROKEN,
         MIN_MIXNET_PACKET_SIZE, MAX_MIXNET_PACKET_SIZE);
 }
 
-int fragment::node_context::node_send(
-    const uint8_t port, mixnet_packet *const packet) {
-    const uint16_t max_port_id = config.num_neighbors;
-    if (port > max_port_id) { return -1; } // Invalid port ID
+void fragment::node_context::_capture(const uint16_t port,
+    const pcapng_writer::direction direction,
+    const mixnet_packet *const packet) {
+    // Only link-level traffic is optional
+    if (pcapng && (pcapng_links ||
+                   (port == config.num_neighbors))) {
+        pcapng->write(port, direction, packet);
+    }
+}
 
-    // Packet size is out-of-bounds
-    if ((packet->total_size < MIN_MIXNET_PACKET_SIZE) ||
-        (packet->total_size > MAX_MIXNET_PACKET_SIZE)) {
-        return -1;
+void fragment::node_context::_pcap_flush_backlog() {
+    while (!pcap_backlog.empty() &&
+           mq_pcap.try_push(pcap_backlog.front())) {
+        pcap_backlog.pop_front();
     }
-    // Bleach reserved field
-    memset(&(packet->_reserved[0]), 0,
-           sizeof(packet->_reserved));
-
-    decltype(packet->total_size) payload_size =
-        (packet->total_size - sizeof(mixnet_packet));
-
-    // Validate size specifications
-    bool validate_size = true;
-    switch (packet->type) {
-    case PACKET_TYPE_STP: {
-        // Check packet size
-        validate_size &= (
-            payload_size == sizeof(mixnet_packet_stp));
-    } break;
+}
 
-    case PACKET_TYPE_FLOOD: {
-        // Check packet size
-        validate_size &= (payload_size == 0);
+void fragment::node_context::_pcap_enqueue(mixnet_packet *const packet) {
+    // Preserve ordering w.r.t. previously overflowed packets
+    _pcap_flush_backlog();
+    if (pcap_backlog.empty() && mq_pcap.try_push(packet)) { return; }
+
+    // The MQ is full, i.e., the pcap thread isn't keeping up
+    switch (pcap_overflow_policy) {
+    // Buffer the packet locally, evicting the oldest one if the
+    // backlog is full. The backlog is drained into the MQ on the
+    // node's subsequent send/recv invocations.
+    case pcap_overflow::DROP_OLDEST: {
+        if (pcap_backlog.size() >= pcap_backlog_capacity) {
+            free(pcap_backlog.front());
+            pcap_backlog.pop_front();
+            pcap_drops++;
+        }
+        pcap_backlog.push_back(packet);
     } break;
 
-    case PACKET_TYPE_LSA: {
-        // Check packet size
-        mixnet_packet_lsa *lsa = reinterpret_cast<
-            mixnet_packet_lsa*>(packet->payload());
+    // Stall the node thread until the MQ frees up (or we time out)
+    case pcap_overflow::BLOCK: {
+        const auto deadline = (clock::now() +
+                               milliseconds(pcap_block_timeout_ms));
+        do {
+            std::this_thread::yield();
+            if (mq_pcap.try_push(packet)) { return; }
+        }
+        while (clock::now() < deadline);
+        free(packet); pcap_drops++;
+    } break;
 
-        validate_size &= (
-            payload_size == (
-                (sizeof(mixnet_packet_lsa)) +
-                (sizeof(mixnet_lsa_link_params) * lsa->neighbor_count))
-        );
+    case pcap_overflow::DROP_NEWEST: {
+        free(packet); pcap_drops++;
     } break;
 
-    case PACKET_TYPE_DATA: {} break;
-    case PACKET_TYPE_PING: {
-        // Check payload size
-        mixnet_packet_routing_header *rh = reinterpret_cast<
-            mixnet_packet_routing_header*>(packet->payload());
+    // This would never arise during normal operation, so by
+    // default, indicate failure and terminate the node thread.
+    case pcap_overflow::FAIL:
+    default: {
+        ts.exited = true;
+        ts.exit_code = (
+            error_code::FRAGMENT_PCAP_MQ_FULL);
 
-        validate_size &= (
-            payload_size == (
-                sizeof(mixnet_packet_ping) +
-                sizeof(mixnet_packet_routing_header) +
-                (sizeof(mixnet_address) * rh->route_length))
-        );
+        free(packet);
+        throw thread_state::exit_exception();
     } break;
-
-    // Unknown packet type
-    default: { validate_size = false; } break;
     } // switch
-    if (!validate_size) { return -1; }
+}
+
+int fragment::node_context::node_send(
+    const uint16_t port, mixnet_packet *const packet) {
+    const uint16_t max_port_id = config.num_neighbors;
+    if (port > max_port_id) { return -1; } // Invalid port ID
+
+    // Validate the packet against the per-type size table.
+    // The user-level port additionally restricts packet types.
+    const bool is_user_port = (port == max_port_id);
+    if (!(is_user_port ? validation::validate_user(packet) :
+                         validation::validate(packet))) {
+        return -1;
+    }
+    // Bleach reserved field
+    packet->_reserved[0] = 0;
+    _capture(port, pcapng_writer::direction::OUTBOUND, packet);
 
     // This is the application-level data port
-    if (port == max_port_id) {
-        if ((packet->type != PACKET_TYPE_FLOOD) &&
-            (packet->type != PACKET_TYPE_DATA) &&
-            (packet->type != PACKET_TYPE_PING)) {
-            return -1;
-        }
+    if (is_user_port) {
         // If the orchestrator is subscribed to pcap updates
-        // from this node, then mirror this packet to the MQ.
-        if (is_pcap_subscribed) {
-            void **ptr = ((void**)
-                message_queue_message_alloc(&mq_pcap));
-
-            // If the MQ failed to allocate memory, it means the
-            // pcap thread isn't consuming fast enough, an issue
-            // that would never arise during normal operation.
-            // Indicate failure and return.
-            if (ptr == NULL) {
-                ts.exited = true;
-                ts.exit_code = (
-                    error_code::FRAGMENT_PCAP_MQ_FULL);
-
-                free(packet);
-                throw thread_state::exit_exception();
-            }
-            *ptr = packet; // Enque the packet
-            message_queue_write(&mq_pcap, ptr);
+        // from this node and the packet passes its filter,
+        // then mirror this packet to the MQ.
+        pcap_subscription_state *subscription = pcap_subscription.load();
+        if ((subscription != nullptr) &&
+            subscription->filter.matches(packet) &&
+            (++(subscription->sample_count) >=
+             subscription->filter.sample_rate)) {
+            subscription->sample_count = 0;
+
+            // The (otherwise bleached) reserved field carries the
+            // delivery time to the pcap thread.
+            packet->_reserved[0] = monotonic_ns();
+            _pcap_enqueue(packet);
         }
         // Else, simply free the packet
         else { free(packet); }
         return 1;
     }
+    // Regular port, io_uring backend (takes ownership)
+    else if (uring) {
+        auto error_code = uring->send(port, packet);
+        if (error_code != error_code::NONE) {
+            ts.exit_code = error_code;
+            ts.exited = true;
+
+            throw thread_state::exit_exception();
+        }
+        return 1;
+    }
+    // Regular port, dedicated I/O threads (takes ownership)
+    else if (io) {
+        auto error_code = io->send(port, packet);
+        if (error_code != error_code::NONE) {
+            ts.exit_code = error_code;
+            ts.exited = true;
+
+            throw thread_state::exit_exception();
+        }
+        return 1;
+    }
     // Regular port
     else {
         auto error_code = _send_blocking(
@@ -195,34 +259,82 @@ int fragment::node_context::node_send(
     return 0;
 }
 
+void fragment::node_context::epoch_synchronize() const {
+    // If the node thread is currently inside a read-side critical
+    // section (odd epoch), wait until it leaves. Any read started
+    // after this point is guaranteed to observe the updated link
+    // state, so we need not wait for it.
+    const uint64_t epoch = rx_epoch.load();
+    if ((epoch & 1) == 0) { return; }
+
+    while ((rx_epoch.load() == epoch) && !ts.exited) {
+        std::this_thread::yield();
+    }
+}
+
 int fragment::node_context::node_recv(
-    uint8_t *const port, mixnet_packet **const ptr) {
+    uint16_t *const port, mixnet_packet **const ptr) {
     // Try to perform RX on the inputs ports round-robin
     const uint16_t max_port_id = config.num_neighbors;
     const uint16_t stop_idx = rx_port_idx;
     int num_recvd = 0;
+
+    // Hand overflowed pcap packets to the pcap thread
+    if (!pcap_backlog.empty()) { _pcap_flush_backlog(); }
+
+    // Flush pending sends and reap link completions
+    if (uring) {
+        auto error_code = uring->poll();
+        if (error_code != error_code::NONE) {
+            ts.exit_code = error_code;
+            ts.exited = true;
+
+            throw thread_state::exit_exception();
+        }
+    }
     do {
         // This is the user-level port
         if (rx_port_idx == max_port_id) {
-            // Consume a packet from the MQ
-            mixnet_packet **mq_ptr = reinterpret_cast<
-                mixnet_packet**>(message_queue_tryread(&mq_user));
-
-            // Valid packet
-            if (mq_ptr != NULL) {
-                num_recvd++; *ptr = *mq_ptr; *port = rx_port_idx;
-                message_queue_message_free(&mq_user, (void*) mq_ptr);
+            // Consume a packet from the MQs (injected packets first)
+            if (mq_user.try_pop(*ptr) || mq_traffic.try_pop(*ptr)) {
+                num_recvd++; *port = rx_port_idx;
+            }
+        }
+        // This is a regular port (io_uring or I/O threads). The
+        // node thread is the only consumer of the received data,
+        // so packets arriving on a disabled link are discarded.
+        else if (uring || io) {
+            if (!link_states[rx_port_idx].load()) {
+                if (uring) { uring->discard(rx_port_idx); }
+                else { io->discard(rx_port_idx); }
+            }
+            else {
+                auto error_code = uring ?
+                    uring->recv(rx_port_idx, ptr) :
+                    io->recv(rx_port_idx, ptr);
+                if (error_code == error_code::NONE) {
+                    num_recvd++; *port = rx_port_idx;
+                }
+                else if (error_code != error_code::RECV_ZERO_PENDING) {
+                    ts.exit_code = error_code;
+                    ts.exited = true;
+
+                    throw thread_state::exit_exception();
+                }
             }
         }
         // This is a regular port
         else {
-            port_mutexes[rx_port_idx].lock();
-            if (link_states[rx_port_idx]) {
+            // Lock-free link-state check; the epoch brackets
+            // the socket read so that the ctrl thread can wait
+            // for it to finish when disabling the link.
+            epoch_enter();
+            if (link_states[rx_port_idx].load()) {
                 auto error_code = _recv_once(
                     rx_socket_fds[rx_port_idx], recv_buffer.get());
 
-                // Unlock mutex
-                port_mutexes[rx_port_idx].unlock();
+                // Leave the read-side critical section
+                epoch_exit();
 
                 // Received a valid packet
                 if (error_code == error_code::NONE) {
@@ -247,8 +359,8 @@ int fragment::node_context::node_recv(
                 // Fallthrough: No packets pending
                 // for this port, try another one.
             }
-            // Unlock mutex
-            else { port_mutexes[rx_port_idx].unlock(); }
+            // Link is down, skip this port
+            else { epoch_exit(); }
         }
         // Compute the next index (round-robin)
         rx_port_idx = ((rx_port_idx + 1) %
@@ -257,17 +369,64 @@ int fragment::node_context::node_recv(
     while ((num_recvd == 0) &&
            (rx_port_idx != stop_idx));
 
+    if (num_recvd != 0) {
+        _capture(*port, pcapng_writer::direction::INBOUND, *ptr);
+    }
     return num_recvd;
 }
 
+void fragment::node_context::node_report_state(
+    const mixnet_address root_address, const uint16_t path_length,
+    const mixnet_address next_hop, const uint16_t lsdb_size) {
+    const uint64_t state = ((static_cast<uint64_t>(root_address) << 48) |
+                            (static_cast<uint64_t>(path_length) << 32) |
+                            (static_cast<uint64_t>(next_hop) << 16) |
+                            lsdb_size);
+
+    // Only record the time of actual changes
+    if ((reported_state_change_ns.load(std::memory_order_relaxed) != 0) &&
+        (reported_state.load(std::memory_order_relaxed) == state)) {
+        return;
+    }
+    const uint32_t seq = reported_state_seq.load(std::memory_order_relaxed);
+    reported_state_seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    reported_state.store(state, std::memory_order_relaxed);
+    reported_state_change_ns.store(monotonic_ns(), std::memory_order_relaxed);
+    reported_state_seq.store(seq + 2, std::memory_order_release);
+}
+
+void fragment::node_context::node_report_counters(
+    const uint64_t stp_packets, const uint64_t lsa_packets,
+    const uint64_t spf_count) {
+    stp_packets_sent.store(stp_packets, std::memory_order_relaxed);
+    lsa_packets_sent.store(lsa_packets, std::memory_order_relaxed);
+    spf_runs.store(spf_count, std::memory_order_relaxed);
+}
+
 void fragment::init_node_context(
     message::request::topology *const p) {
+    // Size the pcap MQ (rounding up to a power of two)
+    uint32_t mq_pcap_depth = 1;
+    while ((mq_pcap_depth < p->pcap_queue_depth) &&
+           (mq_pcap_depth < MAX_MQ_PCAP_DEPTH)) { mq_pcap_depth <<= 1; }
+
+    mq_pcap_ = std::make_unique<packet_channel>(mq_pcap_depth);
     node_context_ = std::make_unique<
-        node_context>(*mq_pcap_, *mq_user_);
+        node_context>(*mq_pcap_, *mq_user_, *mq_traffic_);
+    traffic_ = std::make_unique<traffic_generator>(
+        *mq_traffic_, p->mixaddr);
+
+    node_context_->pcap_overflow_policy = p->pcap_overflow_policy;
+    node_context_->pcap_block_timeout_ms = p->pcap_block_timeout_ms;
+    node_context_->pcap_backlog_capacity = mq_pcap_depth;
 
     mixnet_node_config *config = &(
                 node_context_->config);
 
+    node_context_->transport = link_transport_;
+
     // Initialize mixnet config
     config->node_addr = p->mixaddr;
     config->num_neighbors = p->num_neighbors;
@@ -283,23 +442,85 @@ void fragment::init_node_context(
     memcpy(config->link_costs, p->link_costs(),
            sizeof(uint16_t) * num_neighbors);
 
-    // Allocate port mutexes
-    node_context_->port_mutexes = (
-        std::make_unique<std::mutex[]>(num_neighbors));
+    // Allocate link states (all links start out enabled)
+    node_context_->link_states = (
+        std::make_unique<std::atomic<bool>[]>(num_neighbors));
 
+    for (uint16_t nid = 0; nid < num_neighbors; nid++) {
+        node_context_->link_states[nid].store(true);
+    }
     // Allocate miscellaneous state
     node_context_->tx_socket_fds.resize(num_neighbors, -1);
     node_context_->rx_socket_fds.resize(num_neighbors, -1);
-    node_context_->link_states.resize(num_neighbors, true);
     node_context_->neighbor_netaddrs.resize(num_neighbors, sockaddr_in{});
 }
 
+void fragment::init_capture() {
+    if (options_.pcapng_dir.empty()) { return; }
+    const auto path = (options_.pcapng_dir + "/node_" +
+                       std::to_string(fid_) + ".pcapng");
+
+    node_context_->pcapng_links = options_.pcapng_links;
+    node_context_->pcapng = pcapng_writer::create(
+        path, node_context_->config.num_neighbors,
+        node_context_->config.node_addr);
+
+    if (!node_context_->pcapng) {
+        std::cerr << "[Fragment] Failed to create capture file "
+                  << path << std::endl;
+    }
+}
+
+void fragment::init_link_backend() {
+    using networking::backend;
+    if ((link_backend_ == backend::SOCKET) ||
+        (node_context_->config.num_neighbors == 0)) { return; }
+
+    if (link_backend_ == backend::IO_URING) {
+        node_context_->uring = uring_backend::create(
+            node_context_->rx_socket_fds, node_context_->tx_socket_fds);
+    }
+    else if (link_backend_ == backend::IO_THREADS) {
+        node_context_->io = io_threads::create(
+            node_context_->rx_socket_fds, node_context_->tx_socket_fds,
+            node_context_->link_states.get(), link_transport_,
+            num_io_threads_);
+    }
+    // Fall back to regular socket I/O
+    if (!node_context_->uring && !node_context_->io) {
+        link_backend_ = networking::backend::SOCKET;
+        if (!autotest_mode_) {
+            std::cout << "[Fragment] Link I/O backend is unavailable, "
+                      << "falling back to socket I/O" << std::endl;
+        }
+    }
+}
+
 void fragment::destroy_node_context() {
     // Free allocated resources and reset context
     delete [] node_context_->config.link_costs;
     node_context_.reset();
 }
 
+void fragment::reset_node_context() {
+    // Tear down the previous testcase's node (and its links),
+    // leaving the ctrl and pcap overlays intact.
+    traffic_.reset();
+    destroy_node_context();
+    node_accept_args_.reset();
+
+    // Discard any packets left over from the previous testcase
+    mixnet_packet *packet = NULL;
+    while (mq_pcap_->try_pop(packet)) { free(packet); }
+    while (mq_user_->try_pop(packet)) { free(packet); }
+    while (mq_traffic_->try_pop(packet)) { free(packet); }
+
+    ts_pcap_.exited = false;
+    ts_pcap_.started = false;
+    ts_pcap_.keep_running = true;
+    ts_pcap_.exit_code = error_code::NONE;
+}
+
 /**
  * Helper functions to send/recv data.
  */
@@ -432,8 +653,11 @@ error_code fragment::run_state_setup_ctrl() {
     // Complete handshake
     auto recv_lambda = [this] (const message& msg) {
         fid_ = msg.get_fragment_id();
-        autotest_mode_ = msg.payload<
-            message::request::setup_ctrl>()->autotest_mode;
+        auto p = msg.payload<message::request::setup_ctrl>();
+        autotest_mode_ = p->autotest_mode;
+        link_backend_ = p->link_backend;
+        link_transport_ = p->link_transport;
+        num_io_threads_ = p->num_io_threads;
 
         return error_code::NONE;
     };
@@ -530,14 +754,27 @@ error_code fragment::run_state_start_mixnet_server() {
         [](const message&) { return error_code::NONE; } ));
 
     // Set up the node's TX server
-    node_context_->tx_server_netaddr.sin_family = AF_INET;
-    node_context_->tx_server_netaddr.sin_addr.s_addr = htonl(INADDR_ANY);
-
-    DIE_ON_ERROR(
-        networking::server_setup(
-            &(node_context_->tx_listen_fd),
-            &(node_context_->tx_server_netaddr),
-            node_context_->config.num_neighbors, false));
+    const bool is_local = (link_transport_ ==
+        networking::transport::UNIX_SEQPACKET);
+
+    if (is_local) {
+        node_context_->tx_server_netaddr = local_netaddr(0);
+        DIE_ON_ERROR(
+            networking::local_server_setup(
+                &(node_context_->tx_listen_fd),
+                node_context_->tx_server_netaddr,
+                node_context_->config.num_neighbors));
+    }
+    else {
+        node_context_->tx_server_netaddr.sin_family = AF_INET;
+        node_context_->tx_server_netaddr.sin_addr.s_addr = htonl(INADDR_ANY);
+
+        DIE_ON_ERROR(
+            networking::server_setup(
+                &(node_context_->tx_listen_fd),
+                &(node_context_->tx_server_netaddr),
+                node_context_->config.num_neighbors, false));
+    }
 
     node_accept_args_ = (
         std::make_unique<networking::accept_args>(
@@ -553,10 +790,12 @@ error_code fragment::run_state_start_mixnet_server() {
     while (!node_accept_args_->started) {}
 
     // Acknowledge server startup
-    auto send_lambda = [this] (message& msg) {
+    auto send_lambda = [this, is_local] (message& msg) {
         auto payload = msg.payload<message::response::start_mixnet_server>();
         payload->server_netaddr = node_context_->tx_server_netaddr;
-        payload->server_netaddr.sin_addr.s_addr = ((uint32_t) -1);
+        if (!is_local) {
+            payload->server_netaddr.sin_addr.s_addr = ((uint32_t) -1);
+        }
         return error_code::NONE;
     };
     DIE_DURING_ACCEPT(send_response(true,
@@ -592,27 +831,45 @@ error_code fragment::run_state_start_mixnet_client() {
         message::type::START_MIXNET_CLIENTS, recv_lambda));
 
     // Next, attempt to connect to each neighbor
-    for (uint16_t nid = 0; nid < num_neighbors; nid++) {
+    const bool is_local = (link_transport_ ==
+        networking::transport::UNIX_SEQPACKET);
+
+    for (uint16_t nid = 0; (nid < num_neighbors) && is_local; nid++) {
+        int& fd = node_context_->rx_socket_fds[nid];
+        if ((fd = local_socket(false)) < 0) {
+            DIE_DURING_ACCEPT(error_code::SOCKET_CREATE_FAILED);
+        }
+        // Bind to a unique ID (so the neighbor can resolve us),
+        // then connect to the neighbor's local Mixnet server.
+        if (local_bind(fd, local_netaddr(nid + 1)) < 0) {
+            DIE_DURING_ACCEPT(error_code::SOCKET_BIND_FAILED);
+        }
+        if (local_connect(fd, node_context_->neighbor_netaddrs[nid]) < 0) {
+            DIE_DURING_ACCEPT(error_code::SOCKET_CONNECT_FAILED);
+        }
+    }
+    for (uint16_t nid = 0; (nid < num_neighbors) && !is_local; nid++) {
         if ((node_context_->rx_socket_fds[nid] = (
                 socket(false, false))) < 0) {
             DIE_DURING_ACCEPT(error_code::SOCKET_CREATE_FAILED);
         }
-        // Attempt to connect to the neighbor's Mixnet server
-        sockaddr_in netaddr = node_context_->neighbor_netaddrs[nid];
-        if (connect_with_timeout(node_context_->rx_socket_fds[nid],
-            &(netaddr), sizeof(netaddr), timeout_connect_short_) < 0)
-            { DIE_DURING_ACCEPT(error_code::SOCKET_CONNECT_FAILED); }
+    }
+    // Attempt to connect to all the neighbors' Mixnet servers at once
+    if (!is_local && (connect_all_with_timeout(
+        node_context_->rx_socket_fds, node_context_->neighbor_netaddrs,
+        timeout_connect_short_) < 0)) {
+        DIE_DURING_ACCEPT(error_code::SOCKET_CONNECT_FAILED);
     }
     auto start = clock::now();
     int64_t timer = timeout_connect_short_;
     auto deadline = start + milliseconds(timer);
 
-    do {
+    // Wait until timeout or accept thread finishes
+    while (!node_accept_args_->done && (timer > 0)) {
+        std::this_thread::sleep_for(milliseconds(1));
         timer = duration_cast<milliseconds>(
             deadline - clock::now()).count();
     }
-    // Wait until timeout or accept thread finishes
-    while (!node_accept_args_->done && (timer > 0));
     node_accept_args_->keep_running = false;
     node_accept_thread_.join();
 
@@ -620,14 +877,18 @@ error_code fragment::run_state_start_mixnet_client() {
     if (node_accept_args_->num_accepted != num_neighbors) {
         DIE_DURING_ACCEPT(error_code::SOCKET_ACCEPT_TIMEOUT);
     }
-    auto send_lambda = [this, num_neighbors] (message& msg) {
+    auto send_lambda = [this, num_neighbors, is_local] (message& msg) {
         auto payload = msg.payload<message::
             response::start_mixnet_clients>();
 
         bool success = true;
         payload->num_neighbors = num_neighbors;
         auto client_netaddrs = payload->client_netaddrs();
-        for (uint16_t nid = 0; (nid < num_neighbors) && success; nid++) {
+        for (uint16_t nid = 0; (nid < num_neighbors) && is_local; nid++) {
+            client_netaddrs[nid] = local_netaddr(nid + 1);
+        }
+        for (uint16_t nid = 0; (nid < num_neighbors) &&
+                               success && !is_local; nid++) {
             socklen_t addrlen = sizeof(sockaddr);
             success &= (getsockname(node_context_->rx_socket_fds[nid],
                         (sockaddr*) &(client_netaddrs[nid]), &addrlen) == 0);
@@ -707,11 +968,18 @@ error_code fragment::run_state_run_testcase() {
     auto error_code = error_code::NONE;
     bool end_testcase = false;
 
+    // Hand the Mixnet links to the selected I/O backend
+    init_link_backend();
+    init_capture();
+
     // Launch the helper threads
+    node_context_->node_start_ns = monotonic_ns();
     thread_node_ = std::thread(&fragment::worker_node, this);
     thread_pcap_ = std::thread(&fragment::worker_pcap, this);
 
     while ((error_code == error_code::NONE) && !end_testcase) {
+        std::function<framework::error_code(message&)> respond_lambda = (
+            [](message&) { return error_code::NONE; });
         bool do_respond = false;
         error_code = (recv_request(
             true, true, false, message::type::NOOP,
@@ -733,20 +1001,107 @@ error_code fragment::run_state_run_testcase() {
                 do_respond = true;
             } break;
 
+            // Change a batch of network link states
+            case message::type::CHANGE_LINK_STATE_BATCH: {
+                error_code = task_update_link_state_batch(
+                    msg_ctrl_.payload<message::request::
+                                      change_link_state_batch>());
+
+                do_respond = true;
+            } break;
+
             // Change the pcap subscription
             case message::type::PCAP_SUBSCRIPTION: {
                 error_code = task_update_pcap_subscription(
                     msg_ctrl_.payload<message::request::
-                        pcap_subscription>()->subscribe);
+                                      pcap_subscription>());
 
                 do_respond = true;
             } break;
 
             // Perform packet injection
             case message::type::SEND_PACKET: {
+                uint64_t timestamp_ns = 0;
                 error_code = task_send_packet(msg_ctrl_.
-                    payload<message::request::send_packet>());
+                    payload<message::request::send_packet>(),
+                    &timestamp_ns);
+
+                respond_lambda = [timestamp_ns] (message& m) {
+                    m.payload<message::response::send_packet>()->
+                        timestamp_ns = timestamp_ns;
+                    return error_code::NONE;
+                };
+                do_respond = true;
+            } break;
+
+            // Perform bulk packet injection
+            case message::type::SEND_PACKET_BATCH: {
+                std::vector<uint64_t> timestamps_ns;
+                error_code = task_send_packet_batch(msg_ctrl_.
+                    payload<message::request::send_packet_batch>(),
+                    timestamps_ns);
+
+                respond_lambda = [timestamps_ns = std::move(
+                    timestamps_ns)] (message& m) {
+                    auto payload = m.payload<message::response::
+                                             send_packet_batch>();
+
+                    payload->num_packets = timestamps_ns.size();
+                    memcpy(payload->timestamps_ns(), timestamps_ns.data(),
+                           (timestamps_ns.size() * sizeof(uint64_t)));
+                    return error_code::NONE;
+                };
+                do_respond = true;
+            } break;
 
+            // Start generating traffic locally
+            case message::type::TRAFFIC_PROFILE: {
+                error_code = traffic_->start(msg_ctrl_.payload<
+                    message::request::traffic_profile>());
+
+                do_respond = true;
+            } break;
+
+            // Report the node's state
+            case message::type::CONVERGENCE_STATUS: {
+                respond_lambda = [this] (message& m) {
+                    auto payload = m.payload<message::response::
+                                             convergence_status>();
+
+                    // Retry until the (state, time) pair is consistent
+                    const auto& ctx = *node_context_;
+                    uint64_t state = 0, change_ns = 0;
+                    uint32_t seq_begin = 0, seq_end = 0;
+                    do {
+                        seq_begin = ctx.reported_state_seq.load(
+                            std::memory_order_acquire);
+                        state = ctx.reported_state.load(
+                            std::memory_order_relaxed);
+                        change_ns = ctx.reported_state_change_ns.load(
+                            std::memory_order_relaxed);
+                        std::atomic_thread_fence(std::memory_order_acquire);
+                        seq_end = ctx.reported_state_seq.load(
+                            std::memory_order_relaxed);
+                    } while ((seq_begin & 1) || (seq_begin != seq_end));
+
+                    payload->root_address = (state >> 48);
+                    payload->path_length = ((state >> 32) & 0xFFFF);
+                    payload->next_hop = ((state >> 16) & 0xFFFF);
+                    payload->lsdb_size = (state & 0xFFFF);
+                    payload->has_reported = (change_ns != 0);
+                    payload->stable_ns = ((change_ns != 0) ?
+                        (monotonic_ns() - change_ns) : 0);
+                    payload->last_change_ns = ((change_ns != 0) ?
+                        (change_ns - node_context_->node_start_ns) : 0);
+
+                    payload->stp_packets_sent = (node_context_->
+                        stp_packets_sent.load(std::memory_order_relaxed));
+                    payload->lsa_packets_sent = (node_context_->
+                        lsa_packets_sent.load(std::memory_order_relaxed));
+                    payload->spf_runs = (node_context_->
+                        spf_runs.load(std::memory_order_relaxed));
+                    return error_code::NONE;
+                };
                 do_respond = true;
             } break;
 
@@ -757,6 +1112,17 @@ error_code fragment::run_state_run_testcase() {
 
                 // Only respond if we can clean up ourselves
                 if (error_code == error_code::NONE) {
+                    respond_lambda = [this] (message& m) {
+                        auto payload = m.payload<message::response::
+                                                 end_testcase>();
+                        const auto& stats = traffic_->stats();
+
+                        payload->pcap_drops = node_context_->pcap_drops;
+                        payload->traffic_sent = stats.num_sent;
+                        payload->traffic_drops = stats.num_drops;
+                        payload->traffic_duration_ns = stats.duration_ns;
+                        return error_code::NONE;
+                    };
                     do_respond = true;
                 }
             } break;
@@ -770,7 +1136,7 @@ error_code fragment::run_state_run_testcase() {
             if (do_respond) {
                 // Send a response to the orchestrator
                 error_code = send_response(true, type, error_code,
-                        [](message&) { return error_code::NONE; });
+                                           respond_lambda);
             }
         }
         // Didn't receive a message
@@ -804,18 +1170,20 @@ error_code fragment::run_state_run_testcase() {
 // it's better NOT to reply and wait for the orchestrator's
 // timeout mechanism to kick in and clean up for us.
 error_code fragment::task_end_testcase() {
+    traffic_->stop(); // Stop injecting packets first
     node_context_->ts.keep_running = false;
     ts_pcap_.keep_running = false;
 
-    // Enqueue an empty pointer in the pcap queue to signal completion
-    void **ptr = (void**) message_queue_message_alloc(mq_pcap_.get());
-    if (ptr == NULL) { return error_code::FRAGMENT_EXCEPTION; }
-    *ptr = NULL;
-    message_queue_write(mq_pcap_.get(), (void*) ptr);
+    // Close the pcap MQ to signal completion. This is done out-of-band
+    // (rather than by enqueueing a sentinel) since the node thread is
+    // the only producer allowed on the MQ.
+    mq_pcap_->close();
 
-    // Give threads some time, if required
-    if (!node_context_->ts.exited || !ts_pcap_.exited) {
-        std::this_thread::sleep_for(milliseconds(200));
+    // Give threads some time (up to 200 ms), if required
+    const auto deadline = clock::now() + milliseconds(200);
+    while ((!node_context_->ts.exited || !ts_pcap_.exited) &&
+           (clock::now() < deadline)) {
+        std::this_thread::sleep_for(milliseconds(1));
     }
 
     // Nope, still running
@@ -824,6 +1192,9 @@ error_code fragment::task_end_testcase() {
     }
     thread_pcap_.join();
     thread_node_.join();
+
+    // Packets still awaiting capture will never be delivered
+    node_context_->pcap_drops += node_context_->pcap_backlog.size();
     return error_code::NONE;
 }
 
@@ -831,15 +1202,23 @@ error_code fragment::run_state_do_shutdown() {
     assert(state_ == state_t::SHUTDOWN);
     auto error_code = error_code::NONE; // Retval
 
+    // Await either SHUTDOWN, or RESET (to run another testcase)
     DIE_ON_ERROR(
-        recv_request(true, true, true, message::type::SHUTDOWN,
-                [](const message&) { return error_code::NONE; }));
+        recv_request(true, true, false, message::type::NOOP,
+                [](const message& m) {
+                    return ((m.get_type() == message::type::SHUTDOWN) ||
+                            (m.get_type() == message::type::RESET)) ?
+                        error_code::NONE : error_code::BAD_MESSAGE_CODE; }));
 
-    error_code = send_response(true, message::type::SHUTDOWN,
-        error_code::NONE, [](message&) { return error_code::NONE; });
+    const auto type = msg_ctrl_.get_type();
+    if (type == message::type::RESET) { reset_node_context(); }
+
+    error_code = send_response(true, type, error_code::NONE,
+        [](message&) { return error_code::NONE; });
 
     // Destroy the node context and return
-    if (error_code == error_code::NONE) {
+    if ((error_code == error_code::NONE) &&
+        (type == message::type::SHUTDOWN)) {
         destroy_node_context();
     }
     return error_code;
@@ -864,35 +1243,69 @@ void fragment::worker_node() {
 }
 
 void fragment::worker_pcap() {
+    typedef message::response::pcap_data pcap_data;
     thread_state& ts = ts_pcap_;
     auto error_code = error_code::NONE;
 
+    // Space available for records in a single PCAP_DATA message
+    const size_t max_records_length = (message::MAX_MESSAGE_LENGTH -
+        message::MIN_MESSAGE_LENGTH - sizeof(pcap_data));
+
+    // Since we want this thread to yield when it is not doing
+    // anything useful, we block on the pcap MQ when there is no
+    // batch in progress. Finally, to prevent deadlock scenarios
+    // (possible if the producer thread itself exits), the ctrl
+    // thread closes the MQ, signalling (out-of-band) that it is
+    // out of operation and the thread should return.
+    mixnet_packet *packet = NULL; // Next packet to send
+
     while (ts.keep_running && (error_code == error_code::NONE)) {
-        // Consume packets from the pcap MQ. Since we want this
-        // thread to yield when it is not doing anything useful,
-        // we use blocking read operations. Finally, to prevent
-        // deadlocks scenarios (possible if the producer thread
-        // itself exits), we use the NULL pointer as a sentinel
-        // value, signalling (in-band) that the queue is out of
-        // operation and the thread should return.
-        void *ptr = message_queue_read(mq_pcap_.get());
-        mixnet_packet *packet = *(static_cast<
-                        mixnet_packet**>(ptr));
-
-        message_queue_message_free(mq_pcap_.get(), ptr);
-        if (packet == NULL) { break; } // Got sentinel, done
-        assert(packet->total_size <= MAX_MIXNET_PACKET_SIZE);
-
-        auto send_lambda = [this, packet] (message& msg) {
-            auto payload = msg.payload<mixnet_packet>();
-            memcpy(payload, packet, packet->total_size);
+        // Await the first packet of the next batch
+        if ((packet == NULL) && !mq_pcap_->pop(packet)) {
+            break; // MQ closed, done
+        }
+
+        // Drain the MQ in bulk, packing as many packets as will
+        // fit into a single message. A packet that doesn't fit
+        // is carried over as the head of the next batch. Packets
+        // are truncated to the snaplen of the subscription filter
+        // in effect when the batch is assembled.
+        const auto subscription = node_context_->pcap_subscription.load();
+        const pcap_filter *filter = ((subscription != nullptr) ?
+                                     &(subscription->filter) : nullptr);
+
+        auto send_lambda = [&] (message& msg) {
+            auto payload = msg.payload<pcap_data>();
+            payload->num_records = 0;
+            payload->records_length = 0;
+
+            auto record = payload->records();
+            while (packet != NULL) {
+                assert(packet->total_size <= MAX_MIXNET_PACKET_SIZE);
+                const uint16_t caplen = ((filter != nullptr) ?
+                    filter->caplen(packet) : packet->total_size);
+
+                const size_t size = pcap_data::record::size(caplen);
+                if ((payload->records_length + size) >
+                    max_records_length) { break; }
+
+                record->caplen = caplen;
+                record->timestamp_ns = packet->_reserved[0];
+                memcpy(record->packet(), packet, caplen);
+                record->packet()->_reserved[0] = 0;
+                payload->records_length += size;
+                payload->num_records++;
+                record = record->next();
+                free(packet); packet = NULL;
+                mq_pcap_->try_pop(packet);
+            }
             return error_code::NONE;
         };
         error_code = send_response(false, message::type::PCAP_DATA,
                                    error_code::NONE, send_lambda);
         ts.exit_code = error_code;
-        free(packet);
     }
+    if (packet != NULL) { free(packet); }
     ts.exited = true;
 }
 
@@ -951,10 +1364,12 @@ void fragment::run() {
             next_state = state_t::SHUTDOWN;
         } break;
 
-        // Perform graceful shutdown
+        // Perform graceful shutdown (or, on RESET,
+        // await the next testcase's topology).
         case state_t::SHUTDOWN: {
             error_code = run_state_do_shutdown();
-            next_state = state_t::DONE;
+            next_state = (msg_ctrl_.get_type() == message::type::RESET) ?
+                          state_t::CREATE_TOPOLOGY : state_t::DONE;
         } break;
 
         case state_t::DONE: { break; }
@@ -994,17 +1409,43 @@ void fragment::run() {
 /**
  * Testcase tasks.
  */
-error_code fragment::task_update_pcap_subscription(const bool v) {
-    node_context_->is_pcap_subscribed = v; return error_code::NONE;
+error_code fragment::task_update_pcap_subscription(
+    message::request::pcap_subscription *const p) {
+    if (!p->subscribe) {
+        node_context_->pcap_subscription = nullptr;
+        return error_code::NONE;
+    }
+    auto subscription = std::make_unique<
+        node_context::pcap_subscription_state>();
+
+    pcap_filter *filter = &(subscription->filter);
+    filter->type_mask = p->type_mask;
+    filter->sample_rate = p->sample_rate;
+    filter->snaplen = p->snaplen;
+
+    const mixnet_address *addrs = p->addrs();
+    filter->src_addrs.assign(addrs, addrs + p->num_src_addrs);
+    addrs += p->num_src_addrs;
+    filter->dst_addrs.assign(addrs, addrs + p->num_dst_addrs);
+    filter->finalize();
+
+    // Publish the new filter (see node_context::pcap_subscription),
+    // which starts sampling with a count of 0.
+    node_context_->pcap_subscription = subscription.get();
+    node_context_->pcap_filters.push_back(std::move(subscription));
+    return error_code::NONE;
 }
 
-error_code fragment::task_send_packet(
+/**
+ * Helper function. Builds a user packet from the injection request.
+ * Returns NULL on allocation failure.
+ */
+static mixnet_packet *build_user_packet(
     message::request::send_packet *const p) {
     mixnet_packet *packet = static_cast<mixnet_packet*>(
                         malloc(MAX_MIXNET_PACKET_SIZE));
-    if (packet == NULL) {
-        return error_code::FRAGMENT_EXCEPTION;
-    }
+    if (packet == NULL) { return NULL; }
+
     uint16_t total_size = sizeof(mixnet_packet);
     packet->type = p->type; // Update type
 
@@ -1031,56 +1472,162 @@ error_code fragment::task_send_packet(
     }
     // Set the packet size
     packet->total_size = total_size;
+    return packet;
+}
 
-    void **ptr = (void**) message_queue_message_alloc(mq_user_.get());
+error_code fragment::task_send_packet(
+    message::request::send_packet *const p,
+    uint64_t *const timestamp_ns) {
+    mixnet_packet *packet = build_user_packet(p);
+    if (packet == NULL) {
+        return error_code::FRAGMENT_EXCEPTION;
+    }
     // Error out if the node isn't consuming packets fast enough
-    if (ptr == NULL) { free(packet);
-                       return error_code::FRAGMENT_EXCEPTION; }
-    *ptr = packet;
-    message_queue_write(mq_user_.get(), (void*) ptr);
+    *timestamp_ns = monotonic_ns();
+    if (!mq_user_->try_push(packet)) {
+        free(packet); return error_code::FRAGMENT_EXCEPTION;
+    }
 
     return error_code::NONE;
 }
 
+error_code fragment::task_send_packet_batch(
+    message::request::send_packet_batch *const p,
+    std::vector<uint64_t>& timestamps_ns) {
+    auto error_code = error_code::NONE;
+    std::vector<mixnet_packet*> packets;
+    packets.reserve(p->num_packets);
+
+    // Build every packet up-front
+    size_t offset = 0;
+    auto record = p->packets();
+    for (uint16_t i = 0; (i < p->num_packets) &&
+                         (error_code == error_code::NONE); i++) {
+        offset += message::request::send_packet::size(record->data_length);
+        if ((offset > p->packets_length) ||
+            (record->data_length > MAX_MIXNET_DATA_SIZE)) {
+            error_code = error_code::MALFORMED_MESSAGE;
+            break;
+        }
+        mixnet_packet *packet = build_user_packet(record);
+        if (packet == NULL) {
+            error_code = error_code::FRAGMENT_EXCEPTION;
+            break;
+        }
+        packets.push_back(packet);
+        record = record->next();
+    }
+    // Push the packets in bulk. Unlike single injections, if the
+    // node isn't keeping up, wait for it as long as it makes progress.
+    size_t num_pushed = 0;
+    auto deadline = (clock::now() + milliseconds(SEND_BATCH_TIMEOUT_MS));
+
+    while ((error_code == error_code::NONE) &&
+           (num_pushed < packets.size())) {
+        const uint64_t timestamp_ns = monotonic_ns();
+        const size_t count = mq_user_->try_push_bulk(
+            (packets.data() + num_pushed), (packets.size() - num_pushed));
+
+        timestamps_ns.insert(timestamps_ns.end(), count, timestamp_ns);
+        num_pushed += count;
+
+        if (num_pushed == packets.size()) { break; }
+        else if (count != 0) {
+            deadline = (clock::now() + milliseconds(SEND_BATCH_TIMEOUT_MS));
+        }
+        else if (clock::now() >= deadline) {
+            error_code = error_code::FRAGMENT_EXCEPTION;
+        }
+        std::this_thread::yield();
+    }
+    // Free packets that didn't make it to the node
+    for (size_t i = num_pushed; i < packets.size(); i++) {
+        free(packets[i]);
+    }
+    return error_code;
+}
+
 error_code fragment::task_update_link_state(
     const uint16_t nid, const bool state) {
     auto error_code = error_code::NONE; // Retval
     // Sanity check: Orchestrator must sanitize input
     assert(nid < node_context_->config.num_neighbors);
 
-    // Acquire the mutex for the corresponding port and
-    // update link state. If the link is being disabled,
-    // we also need to drain the socket receive queue.
-    node_context_->port_mutexes[nid].lock();
-    node_context_->link_states[nid] = state;
+    // Publish the new link state. If the link is being disabled,
+    // we also need to drain the socket receive queue, but only once
+    // the node thread is guaranteed to no longer be reading from it.
+    node_context_->link_states[nid].store(state);
 
-    if (!state) {
-        do {
-            // Drain the receive queue
-            error_code = node_context_->_recv_once(
-                node_context_->rx_socket_fds[nid],
-                msg_ctrl_.buffer());
+    // With io_uring (or I/O threads), the RX path is owned by other
+    // threads, which discard packets on disabled links themselves.
+    if (!state && !node_context_->uring && !node_context_->io) {
+        node_context_->epoch_synchronize();
+        error_code = drain_link_rx_queue(nid);
+    }
+    return error_code;
+}
+
+error_code fragment::task_update_link_state_batch(
+    message::request::change_link_state_batch *const p) {
+    auto error_code = error_code::NONE; // Retval
+
+    // Copy the records (draining RX queues clobbers msg_ctrl_)
+    const std::vector<message::request::change_link_state> changes(
+        p->changes(), (p->changes() + p->num_changes));
+
+    // Publish every new link state up-front, so that the node sees
+    // the whole batch at once and a single grace period suffices.
+    bool is_any_disabled = false;
+    for (const auto& change : changes) {
+        assert(change.neighbor_id < node_context_->config.num_neighbors);
+        node_context_->link_states[change.neighbor_id].store(change.state);
+        is_any_disabled |= !change.state;
+    }
+    if (!is_any_disabled || node_context_->uring || node_context_->io) {
+        return error_code;
+    }
+    node_context_->epoch_synchronize();
+    for (const auto& change : changes) {
+        // Only drain links that end up disabled
+        if (node_context_->link_states[change.neighbor_id].load()) {
+            continue;
         }
-        while (error_code == error_code::NONE);
+        error_code = drain_link_rx_queue(change.neighbor_id);
+        if (error_code != error_code::NONE) { break; }
+    }
+    return error_code;
+}
+
+error_code fragment::drain_link_rx_queue(const uint16_t nid) {
+    auto error_code = error_code::NONE; // Retval
+    do {
+        error_code = node_context_->_recv_once(
+            node_context_->rx_socket_fds[nid],
+            msg_ctrl_.buffer());
     }
-    node_context_->port_mutexes[nid].unlock();
+    while (error_code == error_code::NONE);
+
     return (error_code == error_code::RECV_ZERO_PENDING) ?
             error_code::NONE : error_code;
 }
 
-fragment::fragment(const sockaddr_in& orc_netaddr) :
-                   orc_netaddr_(orc_netaddr) {
+fragment::fragment(const sockaddr_in& orc_netaddr,
+                   const options& options) :
+                   options_(options), orc_netaddr_(orc_netaddr) {
     // Initialize MQs
-    mq_pcap_ = std::make_unique<message_queue>();
-    mq_user_ = std::make_unique<message_queue>();
-    message_queue_init(mq_pcap_.get(), sizeof(void*), MQ_PCAP_DEPTH);
-    message_queue_init(mq_user_.get(), sizeof(void*), MQ_USER_DEPTH);
+    mq_pcap_ = std::make_unique<packet_channel>(MQ_PCAP_DEPTH);
+    mq_user_ = std::make_unique<packet_channel>(MQ_USER_DEPTH);
+    mq_traffic_ = std::make_unique<packet_channel>(MQ_USER_DEPTH);
 }
 
 fragment::~fragment() {
-    // Destroy MQs
-    message_queue_destroy(mq_pcap_.get());
-    message_queue_destroy(mq_user_.get());
+    traffic_.reset(); // Stop the generator, if running
+
+    // Free any packets left in the MQs
+    mixnet_packet *packet = NULL;
+    while (mq_pcap_->try_pop(packet)) { free(packet); }
+    while (mq_user_->try_pop(packet)) { free(packet); }
+    while (mq_traffic_->try_pop(packet)) { free(packet); }
 
     // Close local pcap, ctrl sockets
     if (local_fd_pcap_ != -1) {
@@ -1100,15 +1647,72 @@ fragment::~fragment() {
  * C/C++ bridge functions.
  */
 int mixnet_recv(void *h, uint8_t *v, mixnet_packet **p) {
+    auto context = static_cast<framework::fragment::node_context*>(h);
+
+    // The user port must be addressable using 8-bit port IDs
+    if (context->user_port_id() > UINT8_MAX) { return -1; }
+
+    uint16_t port = 0;
+    const int num_recvd = context->node_recv(&port, p);
+    if (num_recvd > 0) { *v = static_cast<uint8_t>(port); }
+    return num_recvd;
+}
+
+int mixnet_send(void *h, const uint8_t v, mixnet_packet *p) {
+    return static_cast<framework::fragment::
+        node_context*>(h)->node_send(v, p);
+}
+
+int mixnet_recv_wide(void *h, uint16_t *v, mixnet_packet **p) {
     return static_cast<framework::fragment::
         node_context*>(h)->node_recv(v, p);
 }
 
-int mixnet_send(void *h, const uint8_t v, mixnet_packet *p) {
+int mixnet_send_wide(void *h, const uint16_t v, mixnet_packet *p) {
     return static_cast<framework::fragment::
         node_context*>(h)->node_send(v, p);
 }
 
+void mixnet_report_state(void *h, const mixnet_address r,
+                         const uint16_t l, const mixnet_address n,
+                         const uint16_t s) {
+    static_cast<framework::fragment::node_context*>(
+        h)->node_report_state(r, l, n, s);
+}
+
+void mixnet_report_counters(void *h, const uint64_t stp,
+                            const uint64_t lsa, const uint64_t spf) {
+    static_cast<framework::fragment::node_context*>(
+        h)->node_report_counters(stp, lsa, spf);
+}
+
+/**
+ * Zygote mode: serves fork requests from the orchestrator on the given
+ * FD. Each request is a fragment count; the reply is the children's
+ * PIDs (-1 on failure). Returns true in the children, which go on to
+ * run as regular fragments, and false once the orchestrator hangs up.
+ */
+static bool run_zygote(const int fd) {
+    signal(SIGCHLD, SIG_IGN); // Don't leave zombie children behind
+
+    uint32_t count = 0;
+    while (framework::networking::read_full(fd, &count, sizeof(count))) {
+        std::vector<pid_t> pids(count, -1);
+        for (uint32_t idx = 0; idx < count; idx++) {
+            pids[idx] = fork();
+            if (pids[idx] == 0) {
+                close(fd);
+                signal(SIGCHLD, SIG_DFL);
+                return true;
+            }
+        }
+        if (!framework::networking::write_full(
+            fd, pids.data(), (pids.size() * sizeof(pid_t)))) { break; }
+    }
+    close(fd);
+    return false;
+}
+
 int main(int argc, char **argv) {
     argparse::ArgumentParser program("Node");
     program.add_argument("orchestrator_ip")
@@ -1117,6 +1721,20 @@ int main(int argc, char **argv) {
     program.add_argument("orchestrator_port")
                         .scan<'u', unsigned int>()
                         .help("Orchestrator's port number");
+
+    program.add_argument("--pcapng")
+                        .default_value(std::string())
+                        .help("Write a local pcapng capture to this directory");
+
+    program.add_argument("--pcapng-links")
+                        .default_value(false)
+                        .implicit_value(true)
+                        .help("Also capture link-level traffic");
+
+    program.add_argument("--zygote")
+                        .default_value(-1)
+                        .scan<'i', int>()
+                        .help("Fork fragments on requests read from this FD");
     try {
         program.parse_args(argc, argv);
     }
@@ -1145,7 +1763,15 @@ int main(int argc, char **argv) {
     orc_netaddr.sin_addr.s_addr = s_addr;
     orc_netaddr.sin_port = htons(port_number);
 
+    framework::fragment::options options;
+    options.pcapng_dir = program.get("--pcapng");
+    options.pcapng_links = (program["--pcapng-links"] == true);
+
+    // Zygote mode: only forked children proceed
+    const int zygote_fd = program.get<int>("--zygote");
+    if ((zygote_fd >= 0) && !run_zygote(zygote_fd)) { return 0; }
+
     // Run the main fragment loop
-    framework::fragment(orc_netaddr).run();
+    framework::fragment(orc_netaddr, options).run();
     return 0;
 }
@@ -13,17 +13,25 @@
 
 #include "error.h"
 #include "message.h"
+#include "io_threads.h"
+#include "latency.h"
 #include "networking.h"
+#include "pcap_filter.h"
+#include "pcapng.h"
+#include "spsc_channel.h"
+#include "traffic_generator.h"
+#include "uring_backend.h"
 #include "mixnet/address.h"
 #include "mixnet/config.h"
-#include "external/itc/message_queue.h"
 
+#include <atomic>
+#include <deque>
 #include <exception>
 #include <functional>
 #include <memory>
-#include <mutex>
 #include <netinet/in.h>
 #include <stdint.h>
+#include <string>
 #include <thread>
 #include <vector>
 
@@ -42,9 +50,14 @@ public:
     // Constant parameters
     static constexpr uint32_t MQ_PCAP_DEPTH = 128;
     static constexpr uint32_t MQ_USER_DEPTH = 128;
+    static constexpr uint32_t MAX_MQ_PCAP_DEPTH = (1 << 16);
     static constexpr uint64_t DEFAULT_TIMEOUT_MS = 5000;
+    static constexpr uint64_t SEND_BATCH_TIMEOUT_MS = 500;
     static constexpr uint16_t INVALID_FRAGMENT_ID = (-1);
 
+    // ITC channel carrying packet pointers between threads
+    typedef spsc_channel<mixnet_packet*> packet_channel;
+
     /**
      * Represents per-thread state.
      */
@@ -58,6 +71,14 @@ public:
         error_code exit_code = error_code::NONE;            // Thread's return code
     };
 
+    /**
+     * Run-time options (set from the command-line).
+     */
+    struct options {
+        std::string pcapng_dir{};                           // Local pcapng capture directory
+        bool pcapng_links = false;                          // Also capture link-level traffic?
+    };
+
     /**
      * Represents a node's private context.
      */
@@ -65,6 +86,8 @@ public:
     private:
         // Mixnet node configuration
         mixnet_node_config config{};                        // This node's configuration
+        networking::transport transport = (                 // Link transport
+            networking::transport::TCP);
         // TX
         int tx_listen_fd = -1;                              // Listen FD (this node as server)
         std::vector<int> tx_socket_fds;                     // Socket FDs (this node as server)
@@ -72,31 +95,95 @@ public:
         // RX
         uint16_t rx_port_idx = 0;                           // Next port to serve (round-robin)
         std::vector<int> rx_socket_fds;                     // Socket FDs (this node as client)
-        std::unique_ptr<std::mutex[]> port_mutexes;         // Mutexes guarding RX socket state
+        std::atomic<uint64_t> rx_epoch{0};                  // RX epoch (odd while reading a port)
         std::vector<sockaddr_in> neighbor_netaddrs;         // Server addrs of neighboring nodes
         // ITC
         thread_state ts{};                                  // Thread state
-        message_queue& mq_pcap;                             // MQ for pcap data
-        message_queue& mq_user;                             // MQ for user-injected packets
+        packet_channel& mq_pcap;                            // MQ for pcap data
+        packet_channel& mq_user;                            // MQ for user-injected packets
+        packet_channel& mq_traffic;                         // MQ for generated packets
         // Miscellaneous
-        std::vector<bool> link_states;                      // NID -> Link state (up: true)
+        std::unique_ptr<std::atomic<bool>[]> link_states;   // NID -> Link state (up: true)
         std::unique_ptr<char[]> recv_buffer{};              // Scratch receive packet buffer
-        volatile bool is_pcap_subscribed = false;           // Orchestrator subscribed for pcap?
+        std::unique_ptr<uring_backend> uring{};             // io_uring link I/O (if enabled)
+        std::unique_ptr<io_threads> io{};                   // Dedicated link I/O threads (if enabled)
+        std::unique_ptr<pcapng_writer> pcapng{};            // Local capture file (if enabled)
+        bool pcapng_links = false;                          // Capture link-level traffic?
+        // Pcap subscription. The ctrl thread publishes a new filter by
+        // swapping the pointer; since subscription changes are rare,
+        // superseded filters are retained until the context is torn
+        // down, so readers never observe a freed filter. Each filter
+        // carries its own sampling state, so every new subscription
+        // samples from scratch.
+        struct pcap_subscription_state {
+            pcap_filter filter{};                           // Subscription filter
+            uint16_t sample_count = 0;                      // Matches since last capture
+                                                            // (node thread only)
+        };
+        std::atomic<pcap_subscription_state*> pcap_subscription{nullptr};
+        std::vector<std::unique_ptr<pcap_subscription_state>> pcap_filters{};
+        // Pcap MQ overflow handling
+        pcap_overflow pcap_overflow_policy{};               // Policy when the MQ is full
+        uint16_t pcap_block_timeout_ms = 0;                 // Timeout for pcap_overflow::BLOCK
+        std::deque<mixnet_packet*> pcap_backlog{};          // Packets awaiting MQ space
+        size_t pcap_backlog_capacity = 0;                   // Max backlog size (DROP_OLDEST)
+        uint64_t pcap_drops = 0;                            // Captured packets dropped
+        // Node-reported state (see mixnet_report_state()), packed as
+        // (root, path length, next hop, LSDB size), and the time it
+        // last changed (0 if the node has yet to report any state).
+        // The node thread is the only writer; readers use the seqlock
+        // (odd while an update is in progress) to get a matching pair.
+        std::atomic<uint32_t> reported_state_seq{0};
+        std::atomic<uint64_t> reported_state{0};
+        std::atomic<uint64_t> reported_state_change_ns{0};
+        uint64_t node_start_ns = 0;                         // Time the node thread started
+        // Node-reported counters (see mixnet_report_counters())
+        std::atomic<uint64_t> stp_packets_sent{0};
+        std::atomic<uint64_t> lsa_packets_sent{0};
+        std::atomic<uint64_t> spf_runs{0};
 
         /**
          * Helper methods.
          */
         error_code _recv_once(const int fd, char *const buffer);
         error_code _send_blocking(const int fd, const char *const buffer);
+        void _pcap_enqueue(mixnet_packet *const packet);
+        void _pcap_flush_backlog();
+        void _capture(const uint16_t port, const pcapng_writer::direction
+                      direction, const mixnet_packet *const packet);
+
+        /**
+         * Epoch-based handoff for RX socket state. The node thread
+         * brackets every per-port read with epoch_enter/exit(); the
+         * ctrl thread, having unpublished a link, calls the epoch_
+         * synchronize() method to wait out any in-flight read before
+         * touching the socket itself.
+         */
+        void epoch_enter() { rx_epoch.fetch_add(1); }
+        void epoch_exit() { rx_epoch.fetch_add(1); }
+        void epoch_synchronize() const;
 
     public:
         ~node_context();
         DISALLOW_COPY_AND_ASSIGN(node_context);
-        explicit node_context(message_queue& mq_pcap,
-                              message_queue& mq_user);
+        explicit node_context(packet_channel& mq_pcap,
+                              packet_channel& mq_user,
+                              packet_channel& mq_traffic);
+
+        int node_send(const uint16_t port, mixnet_packet *const packet);
+        int node_recv(uint16_t *const port, mixnet_packet **const packet);
+
+        void node_report_state(const mixnet_address root_address,
+                               const uint16_t path_length,
+                               const mixnet_address next_hop,
+                               const uint16_t lsdb_size);
+
+        void node_report_counters(const uint64_t stp_packets_sent,
+                                  const uint64_t lsa_packets_sent,
+                                  const uint64_t spf_runs);
 
-        int node_send(const uint8_t port, mixnet_packet *const packet);
-        int node_recv(uint8_t *const port, mixnet_packet **const packet);
+        // ID of the user-level port (i.e., the number of neighbors)
+        uint16_t user_port_id() const { return config.num_neighbors; }
 
         // Expose internal state
         friend class fragment;
@@ -121,7 +208,13 @@ private:
 
     // Fragment state
     uint16_t fid_ = -1;                                     // Fragment's unique ID
+    const options options_;                                 // Command-line options
     bool autotest_mode_ = false;                            // Fragment in autotest mode?
+    networking::backend link_backend_ = (                   // I/O backend for Mixnet links
+        networking::backend::SOCKET);
+    networking::transport link_transport_ = (               // Transport for Mixnet links
+        networking::transport::TCP);
+    uint16_t num_io_threads_ = 1;                           // Link I/O threads (if enabled)
     state_t state_ = state_t::SETUP_CTRL;                   // Fragment's current FSM state
 
     // Networking
@@ -140,8 +233,10 @@ private:
     thread_state ts_pcap_{};                                // Thread state for pcap
     std::thread thread_node_;                               // Thread running node impl
     std::thread thread_pcap_;                               // Thread handling pcap plane
-    std::unique_ptr<message_queue> mq_pcap_{};              // MQ for packet capture data
-    std::unique_ptr<message_queue> mq_user_{};              // MQ for user-injected packets
+    std::unique_ptr<packet_channel> mq_pcap_{};             // MQ for packet capture data
+    std::unique_ptr<packet_channel> mq_user_{};             // MQ for user-injected packets
+    std::unique_ptr<packet_channel> mq_traffic_{};          // MQ for generated packets
+    std::unique_ptr<traffic_generator> traffic_{};          // Local traffic generator
 
     // Temporary FSM state
     std::thread node_accept_thread_;                        // Thread for accepting connections
@@ -154,6 +249,9 @@ private:
     void worker_pcap(); // Run thread handling the pcap stream
 
     void destroy_node_context();
+    void reset_node_context();
+    void init_capture();
+    void init_link_backend();
     void init_node_context(message::request::topology *const p);
 
     void prepare_header(message& m, const message::type type,
@@ -193,14 +291,23 @@ private:
      * Fragment testcase tasks.
      */
     error_code task_end_testcase();
-    error_code task_update_pcap_subscription(const bool subscribe);
-    error_code task_send_packet(message::request::send_packet *const p);
+    error_code task_update_pcap_subscription(
+        message::request::pcap_subscription *const p);
+    error_code task_send_packet(message::request::send_packet *const p,
+                                uint64_t *const timestamp_ns);
+    error_code task_send_packet_batch(
+        message::request::send_packet_batch *const p,
+        std::vector<uint64_t>& timestamps_ns);
     error_code task_update_link_state(const uint16_t nid, const bool state);
+    error_code task_update_link_state_batch(
+        message::request::change_link_state_batch *const p);
+    error_code drain_link_rx_queue(const uint16_t nid);
 
 public:
     ~fragment();
     DISALLOW_COPY_AND_ASSIGN(fragment);
-    explicit fragment(const sockaddr_in& orc_netaddr);
+    explicit fragment(const sockaddr_in& orc_netaddr,
+                      const options& options);
 
     // Public interface
     void run();
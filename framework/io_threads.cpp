@@ -0,0 +1,257 @@
+/**
+ * Copyright (C) 2023 Carnegie Mellon University
+ *
+ * This file is part of the Mixnet course project developed for
+ * the Computer Networks course (15-441/641) taught at Carnegie
+ * Mellon University.
+ *
+ * No part of the Mixnet project may be copied and/or distributed
+ * without the express permission of the 15-441/641 course staff.
+ */
+#include "io_threads.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <errno.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace framework {
+
+// Poll interval while some RX queue is full (in ms)
+static constexpr int RX_BACKOFF_MS = 1;
+
+io_threads::io_threads(const std::atomic<bool> *link_states,
+                       const networking::transport transport) :
+                       link_states_(link_states),
+                       transport_(transport) {}
+
+io_threads::~io_threads() {
+    // Stop and join the I/O threads
+    keep_running_ = false;
+    for (uint16_t wid = 0; wid < num_workers_; wid++) {
+        worker_state& worker = workers_[wid];
+        if (worker.thread.joinable()) {
+            wake(worker); worker.thread.join();
+        }
+        if (worker.event_fd != -1) { close(worker.event_fd); }
+    }
+    // Free any packets left in flight
+    mixnet_packet *packet = nullptr;
+    for (uint16_t port = 0; port < num_ports_; port++) {
+        while (ports_[port].rx_queue.try_pop(packet)) { free(packet); }
+        while (ports_[port].tx_queue.try_pop(packet)) { free(packet); }
+    }
+}
+
+bool io_threads::setup(const std::vector<int>& rx_fds,
+                       const std::vector<int>& tx_fds,
+                       const uint16_t num_threads) {
+    assert(rx_fds.size() == tx_fds.size());
+    num_ports_ = static_cast<uint16_t>(rx_fds.size());
+    ports_ = std::make_unique<port_state[]>(num_ports_);
+    for (uint16_t port = 0; port < num_ports_; port++) {
+        ports_[port].rx_fd = rx_fds[port];
+        ports_[port].tx_fd = tx_fds[port];
+    }
+    // Shard the ports across the I/O threads
+    const uint16_t num_workers = std::min<uint16_t>(
+        std::min(num_threads, MAX_NUM_THREADS), num_ports_);
+    if (num_workers == 0) { return false; } // No threads (or ports)
+
+    workers_ = std::make_unique<worker_state[]>(num_workers);
+    for (uint16_t port = 0; port < num_ports_; port++) {
+        workers_[port % num_workers].ports.push_back(port);
+    }
+    for (uint16_t wid = 0; wid < num_workers; wid++) {
+        worker_state& worker = workers_[wid];
+        worker.event_fd = eventfd(0, EFD_NONBLOCK);
+        if (worker.event_fd < 0) { return false; }
+
+        worker.thread = std::thread(&io_threads::worker_loop,
+                                    this, std::ref(worker));
+        num_workers_++;
+    }
+    return (num_workers_ != 0);
+}
+
+std::unique_ptr<io_threads> io_threads::create(
+    const std::vector<int>& rx_fds, const std::vector<int>& tx_fds,
+    const std::atomic<bool> *link_states,
+    const networking::transport transport,
+    const uint16_t num_threads) {
+    auto threads = std::make_unique<io_threads>(link_states, transport);
+    if (!threads->setup(rx_fds, tx_fds, num_threads)) { threads.reset(); }
+    return threads;
+}
+
+void io_threads::wake(worker_state& worker) {
+    const uint64_t one = 1;
+    ssize_t rc = write(worker.event_fd, &one, sizeof(one));
+    (void) rc; // The counter saturating is fine
+}
+
+bool io_threads::do_tx(worker_state& worker) {
+    using namespace networking;
+    config c{mode::RX_TX_BLOCKING, 0};
+    bool progress = false;
+
+    for (const uint16_t port : worker.ports) {
+        port_state& state = ports_[port];
+        mixnet_packet *packet = nullptr;
+        while (state.tx_queue.try_pop(packet)) {
+            auto error_code = error_code::NONE;
+            if (tx_error_ == error_code::NONE) {
+                const char *b = reinterpret_cast<const char*>(packet);
+                error_code = (transport_ == transport::UNIX_SEQPACKET) ?
+                    send_datagram<uint16_t>(c, state.tx_fd, b,
+                        error_code::MIXNET_CONNECTION_BROKEN,
+                        MIN_MIXNET_PACKET_SIZE, MAX_MIXNET_PACKET_SIZE) :
+                    send_generic<uint16_t>(c, state.tx_fd, b,
+                        error_code::MIXNET_CONNECTION_BROKEN,
+                        MIN_MIXNET_PACKET_SIZE, MAX_MIXNET_PACKET_SIZE);
+            }
+            // Latch the first TX error (it is fatal for the node)
+            if (error_code != error_code::NONE) {
+                tx_error_ = error_code;
+            }
+            free(packet);
+            progress = true;
+        }
+    }
+    return progress;
+}
+
+void io_threads::do_rx(const uint16_t port, char *const buffer) {
+    using namespace networking;
+    config c{mode::RX_TRY_ONCE, 0};
+    port_state& state = ports_[port];
+
+    // Consume packets until the socket or the queue runs dry
+    while (state.rx_queue.size() < state.rx_queue.capacity()) {
+        auto error_code = (transport_ == transport::UNIX_SEQPACKET) ?
+            recv_datagram<uint16_t>(c, state.rx_fd, buffer,
+                error_code::MIXNET_CONNECTION_BROKEN,
+                MIN_MIXNET_PACKET_SIZE, MAX_MIXNET_PACKET_SIZE) :
+            recv_generic<uint16_t>(c, state.rx_fd, buffer,
+                error_code::MIXNET_CONNECTION_BROKEN,
+                MIN_MIXNET_PACKET_SIZE, MAX_MIXNET_PACKET_SIZE);
+
+        if (error_code == error_code::RECV_ZERO_PENDING) { break; }
+        else if (error_code != error_code::NONE) {
+            state.rx_error = error_code;
+            break;
+        }
+        // Link is down, drop the packet
+        if (!link_states_[port].load()) { continue; }
+
+        const uint16_t length = reinterpret_cast<
+            mixnet_packet*>(buffer)->total_size;
+
+        auto packet = static_cast<mixnet_packet*>(malloc(length));
+        memcpy(packet, buffer, length);
+        state.rx_queue.try_push(packet); // Never fails
+    }
+}
+
+void io_threads::worker_loop(worker_state& worker) {
+    auto buffer = std::make_unique<char[]>(MAX_MIXNET_PACKET_SIZE);
+
+    // Slot 0 is the wakeup eventfd, followed by the RX sockets
+    std::vector<pollfd> pfds(worker.ports.size() + 1);
+    pfds[0].fd = worker.event_fd;
+    pfds[0].events = POLLIN;
+
+    bool rx_full = false;
+    while (keep_running_) {
+        // Perform all the pending TX work first
+        bool progress = do_tx(worker);
+
+        // Only watch sockets whose RX queue has space
+        rx_full = false;
+        for (size_t i = 0; i < worker.ports.size(); i++) {
+            const port_state& state = ports_[worker.ports[i]];
+            const bool is_ready = (
+                (state.rx_error == error_code::NONE) &&
+                (state.rx_queue.size() < state.rx_queue.capacity()));
+
+            rx_full |= ((state.rx_error == error_code::NONE) && !is_ready);
+            pfds[i + 1].fd = (is_ready ? state.rx_fd : -1);
+            pfds[i + 1].events = POLLIN;
+            pfds[i + 1].revents = 0;
+        }
+        // Announce that we are about to block, then re-check the
+        // TX queues so that a concurrent send() can't be missed.
+        int timeout = (rx_full ? RX_BACKOFF_MS : -1);
+        if (!progress) {
+            worker.sleeping.store(true);
+            for (const uint16_t port : worker.ports) {
+                if (!ports_[port].tx_queue.empty()) { timeout = 0; break; }
+            }
+        }
+        else { timeout = 0; }
+
+        int rc = poll(pfds.data(), pfds.size(), timeout);
+        worker.sleeping.store(false);
+        if ((rc < 0) && (errno != EINTR)) { break; }
+
+        // Reset the wakeup counter
+        if (pfds[0].revents & POLLIN) {
+            uint64_t counter = 0;
+            ssize_t ret = read(worker.event_fd, &counter, sizeof(counter));
+            (void) ret; // Spurious wakeups are harmless
+        }
+        for (size_t i = 0; (rc > 0) && (i < worker.ports.size()); i++) {
+            if (pfds[i + 1].revents != 0) {
+                do_rx(worker.ports[i], buffer.get());
+            }
+        }
+    }
+}
+
+error_code io_threads::recv(const uint16_t port,
+                            mixnet_packet **const packet) {
+    port_state& state = ports_[port];
+    if (state.rx_queue.try_pop(*packet)) { return error_code::NONE; }
+
+    // The I/O thread latches errors after enqueueing the packets
+    // that preceded them, so re-check the queue once it has.
+    auto error_code = state.rx_error.load();
+    if (error_code == error_code::NONE) {
+        return error_code::RECV_ZERO_PENDING;
+    }
+    return (state.rx_queue.try_pop(*packet) ?
+            error_code::NONE : error_code);
+}
+
+void io_threads::discard(const uint16_t port) {
+    mixnet_packet *packet = nullptr;
+    while (ports_[port].rx_queue.try_pop(packet)) { free(packet); }
+}
+
+error_code io_threads::send(const uint16_t port,
+                            mixnet_packet *const packet) {
+    port_state& state = ports_[port];
+    worker_state& worker = workers_[port % num_workers_];
+
+    // Apply backpressure if the I/O thread isn't keeping up
+    bool enqueued = false;
+    while (!(enqueued = state.tx_queue.try_push(packet))) {
+        if (tx_error_ != error_code::NONE) { break; }
+        wake(worker); std::this_thread::yield();
+    }
+    if (!enqueued) { free(packet); }
+
+    auto error_code = tx_error_.load();
+    if (error_code != error_code::NONE) { return error_code; }
+
+    // Wake the I/O thread if it is (about to be) blocked
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (worker.sleeping.load()) { wake(worker); }
+    return error_code::NONE;
+}
+
+} // namespace framework
@@ -0,0 +1,132 @@
+/**
+ * Copyright (C) 2023 Carnegie Mellon University
+ *
+ * This file is part of the Mixnet course project developed for
+ * the Computer Networks course (15-441/641) taught at Carnegie
+ * Mellon University.
+ *
+ * No part of the Mixnet project may be copied and/or distributed
+ * without the express permission of the 15-441/641 course staff.
+ */
+#ifndef FRAMEWORK_IO_THREADS_H_
+#define FRAMEWORK_IO_THREADS_H_
+
+#include "error.h"
+#include "networking.h"
+#include "spsc_queue.h"
+#include "mixnet/packet.h"
+
+#include <atomic>
+#include <memory>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+namespace framework {
+
+// Helper macros
+#define DISALLOW_COPY_AND_ASSIGN(TypeName)                  \
+    TypeName(const TypeName&) = delete;                     \
+    void operator=(const TypeName&) = delete
+
+/**
+ * Dedicated I/O threads for a node's neighbor ports. Each thread owns
+ * a shard of the ports (port % num_threads), performs all socket RX
+ * and TX for them, and exchanges packet pointers with the node thread
+ * via per-port SPSC queues. The node thread thus only runs the node's
+ * logic; I/O threads sleep in poll() when there is no work to do.
+ */
+class io_threads final {
+public:
+    // Constant parameters
+    static constexpr size_t QUEUE_DEPTH = 256;
+    static constexpr uint16_t MAX_NUM_THREADS = 16;
+
+private:
+    // Per-port state
+    struct port_state {
+        int rx_fd = -1;                                 // FD to receive on
+        int tx_fd = -1;                                 // FD to send on
+        std::atomic<error_code> rx_error{               // Latched RX error
+            error_code::NONE};
+        spsc_queue<mixnet_packet*> rx_queue{            // I/O thread -> Node
+            QUEUE_DEPTH};
+        spsc_queue<mixnet_packet*> tx_queue{            // Node -> I/O thread
+            QUEUE_DEPTH};
+    };
+    // Per-thread state
+    struct worker_state {
+        int event_fd = -1;                              // Wakeup eventfd
+        std::atomic<bool> sleeping{false};              // Blocked in poll()?
+        std::vector<uint16_t> ports;                    // Ports served
+        std::thread thread;                             // Thread handle
+    };
+
+    uint16_t num_ports_ = 0;                            // Number of ports
+    uint16_t num_workers_ = 0;                          // Number of I/O threads
+    std::unique_ptr<port_state[]> ports_{};             // Port ID -> State
+    std::unique_ptr<worker_state[]> workers_{};         // Worker ID -> State
+    const std::atomic<bool> *link_states_ = nullptr;    // Port ID -> Link state
+    networking::transport transport_ = (                // Link transport
+        networking::transport::TCP);
+
+    std::atomic<bool> keep_running_{true};              // ITC synchronization
+    std::atomic<error_code> tx_error_{                  // Latched TX error
+        error_code::NONE};
+
+    /**
+     * Internal helper methods.
+     */
+    bool setup(const std::vector<int>& rx_fds,
+               const std::vector<int>& tx_fds,
+               const uint16_t num_threads);
+
+    void wake(worker_state& worker);
+    void worker_loop(worker_state& worker);
+    bool do_tx(worker_state& worker);
+    void do_rx(const uint16_t port, char *const buffer);
+
+public:
+    ~io_threads();
+    DISALLOW_COPY_AND_ASSIGN(io_threads);
+    explicit io_threads(const std::atomic<bool> *link_states,
+                        const networking::transport transport);
+
+    /**
+     * Creates and starts the I/O threads for the given neighbor FDs.
+     * Returns nullptr if the threads could not be set up (including
+     * if num_threads is 0); callers should then fall back to
+     * performing I/O on the node thread.
+     */
+    static std::unique_ptr<io_threads> create(
+        const std::vector<int>& rx_fds, const std::vector<int>& tx_fds,
+        const std::atomic<bool> *link_states,
+        const networking::transport transport,
+        const uint16_t num_threads);
+
+    /**
+     * Pops the next packet received on the given port, if any. Returns
+     * RECV_ZERO_PENDING if none is available, or the error latched for
+     * this port's connection.
+     */
+    error_code recv(const uint16_t port, mixnet_packet **const packet);
+
+    /**
+     * Discards every packet received on the given port so far (used
+     * while the corresponding link is disabled).
+     */
+    void discard(const uint16_t port);
+
+    /**
+     * Queues a packet for transmission on the given port, taking
+     * ownership of it. Blocks only if the port's TX queue is full.
+     */
+    error_code send(const uint16_t port, mixnet_packet *const packet);
+};
+
+// Cleanup
+#undef DISALLOW_COPY_AND_ASSIGN
+
+} // namespace framework
+
+#endif // FRAMEWORK_IO_THREADS_H_
@@ -0,0 +1,221 @@
+/**
+ * Copyright (C) 2023 Carnegie Mellon University
+ *
+ * This file is part of the Mixnet course project developed for
+ * the Computer Networks course (15-441/641) taught at Carnegie
+ * Mellon University.
+ *
+ * No part of the Mixnet project may be copied and/or distributed
+ * without the express permission of the 15-441/641 course staff.
+ */
+#include "latency.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <string.h>
+
+namespace framework {
+
+/**
+ * latency_histogram.
+ */
+uint32_t latency_histogram::bucket_index(const uint64_t value) {
+    if (value < NUM_SUB_BUCKETS) { return static_cast<uint32_t>(value); }
+
+    // Values in [2^e, 2^(e + 1)) map to bucket group (e - BITS + 1)
+    const uint32_t exponent = (63 - __builtin_clzll(value));
+    const uint32_t shift = (exponent - SUB_BUCKET_BITS);
+    const uint32_t sub_bucket = static_cast<uint32_t>(
+        (value >> shift) - NUM_SUB_BUCKETS);
+
+    return (((shift + 1) * NUM_SUB_BUCKETS) + sub_bucket);
+}
+
+uint64_t latency_histogram::bucket_lower_bound(const uint32_t index) {
+    if (index < NUM_SUB_BUCKETS) { return index; }
+
+    const uint32_t shift = ((index / NUM_SUB_BUCKETS) - 1);
+    const uint64_t sub_bucket = (index % NUM_SUB_BUCKETS);
+    return ((NUM_SUB_BUCKETS + sub_bucket) << shift);
+}
+
+void latency_histogram::record(const uint64_t value) {
+    counts_[bucket_index(value)]++;
+    count_++; sum_ += value;
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+}
+
+void latency_histogram::merge(const latency_histogram& other) {
+    for (uint32_t index = 0; index < NUM_BUCKETS; index++) {
+        counts_[index] += other.counts_[index];
+    }
+    count_ += other.count_; sum_ += other.sum_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+}
+
+uint64_t latency_histogram::percentile(const double p) const {
+    if (count_ == 0) { return 0; }
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(
+        std::ceil((p / 100.0) * static_cast<double>(count_))));
+
+    uint64_t seen = 0;
+    for (uint32_t index = 0; index < NUM_BUCKETS; index++) {
+        seen += counts_[index];
+        if (seen >= rank) {
+            // Report the bucket's midpoint, clamped to the samples seen
+            const uint64_t lower = bucket_lower_bound(index);
+            const uint64_t upper = ((index + 1) < NUM_BUCKETS) ?
+                bucket_lower_bound(index + 1) : max_;
+
+            const uint64_t value = (lower + ((upper - lower) / 2));
+            return std::min(std::max(value, min()), max_);
+        }
+    }
+    return max_;
+}
+
+/**
+ * latency_tracker.
+ */
+uint64_t latency_tracker::digest(const char *data, const size_t length) {
+    uint64_t hash = 0xcbf29ce484222325ULL; // FNV-1a
+    for (size_t i = 0; i < length; i++) {
+        hash ^= static_cast<uint8_t>(data[i]);
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+bool latency_tracker::is_tagged(const mixnet_packet_type_t type,
+                                const char *data, const size_t length) const {
+    return (tag_.empty() || ((type == PACKET_TYPE_DATA) &&
+            (length >= tag_.size()) &&
+            (memcmp(data, tag_.data(), tag_.size()) == 0)));
+}
+
+void latency_tracker::expire(const uint64_t now_ns) {
+    for (auto iter = pending_.begin(); iter != pending_.end();) {
+        auto& events = iter->second;
+        while (!events.injected.empty() && ((events.injected.front() +
+               MAX_INJECTION_AGE_NS) < now_ns)) { events.injected.pop_front(); }
+
+        while (!events.delivered.empty() && ((events.delivered.front() +
+               MAX_DELIVERY_AGE_NS) < now_ns)) { events.delivered.pop_front(); }
+
+        if (events.injected.empty() && events.delivered.empty()) {
+            iter = pending_.erase(iter);
+        }
+        else { iter++; }
+    }
+    next_expiry_ns_ = (now_ns + EXPIRY_INTERVAL_NS);
+}
+
+void latency_tracker::match(const match_key& key,
+                            const uint64_t timestamp_ns,
+                            const bool is_injection) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (timestamp_ns >= next_expiry_ns_) { expire(timestamp_ns); }
+    auto iter = pending_.find(key);
+
+    // Pair this event with the oldest unmatched counterpart, if any
+    if ((iter == pending_.end()) || (is_injection ?
+        iter->second.delivered : iter->second.injected).empty()) {
+        if (iter == pending_.end()) {
+            iter = pending_.emplace(key, pending_events()).first;
+        }
+        auto& events = (is_injection ? iter->second.injected :
+                                       iter->second.delivered);
+        if (events.size() >= MAX_PENDING_EVENTS) { events.pop_front(); }
+        events.push_back(timestamp_ns);
+        return;
+    }
+    auto& counterparts = (is_injection ? iter->second.delivered :
+                                         iter->second.injected);
+    const uint64_t injected = (is_injection ? timestamp_ns : counterparts.front());
+    const uint64_t delivered = (is_injection ? counterparts.front() : timestamp_ns);
+    counterparts.pop_front();
+
+    // Fully matched, so drop the key
+    if (iter->second.injected.empty() &&
+        iter->second.delivered.empty()) { pending_.erase(iter); }
+
+    histograms_[flow(key.src, key.dst)].record(
+        (delivered > injected) ? (delivered - injected) : 0);
+}
+
+void latency_tracker::on_inject(
+    const mixnet_address src, const mixnet_address dst,
+    const mixnet_packet_type_t type, const char *data,
+    const size_t data_length, const uint64_t timestamp_ns) {
+    // Deliveries of other types are never matched (see on_deliver())
+    if (((type != PACKET_TYPE_DATA) && (type != PACKET_TYPE_PING)) ||
+        !is_tagged(type, data, data_length)) { return; }
+
+    // Only DATA packets carry the injected payload
+    const size_t length = ((type == PACKET_TYPE_DATA) ? data_length : 0);
+    match(match_key{src, dst, type, digest(data, length)},
+          timestamp_ns, true);
+}
+
+void latency_tracker::on_deliver(const mixnet_packet *const packet,
+                                 const uint64_t timestamp_ns) {
+    if ((packet->type != PACKET_TYPE_DATA) &&
+        (packet->type != PACKET_TYPE_PING)) { return; }
+
+    auto rh = reinterpret_cast<const mixnet_packet_routing_header*>(
+                                                    packet->payload());
+    const size_t header_size = (sizeof(mixnet_packet) + sizeof(*rh) +
+                                (rh->route_length * sizeof(mixnet_address)));
+    if (header_size > packet->total_size) { return; }
+
+    const char *data = (packet->payload() + (header_size - sizeof(mixnet_packet)));
+    size_t length = (packet->total_size - header_size);
+    if (!is_tagged(packet->type, data, length)) { return; }
+
+    // PING responses are generated by the destination, not injected
+    if (packet->type == PACKET_TYPE_PING) {
+        auto ping = reinterpret_cast<const mixnet_packet_ping*>(data);
+        if (!ping->is_request) { return; }
+        length = 0;
+    }
+    match(match_key{rh->src_address, rh->dst_address,
+                    packet->type, digest(data, length)},
+          timestamp_ns, false);
+}
+
+std::map<latency_tracker::flow, latency_histogram>
+latency_tracker::histograms() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return histograms_;
+}
+
+void latency_tracker::report(std::ostream& os) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto flags = os.flags();
+    const auto precision = os.precision();
+
+    for (const auto& [flow, histogram] : histograms_) {
+        os << "[Latency] " << flow.first << " -> " << flow.second
+           << ": n=" << histogram.count() << std::fixed
+           << std::setprecision(1) << " (us) min="
+           << (histogram.min() / 1e3) << " p50="
+           << (histogram.percentile(50) / 1e3) << " p90="
+           << (histogram.percentile(90) / 1e3) << " p99="
+           << (histogram.percentile(99) / 1e3) << " max="
+           << (histogram.max() / 1e3) << std::endl;
+    }
+    os.flags(flags);
+    os.precision(precision);
+}
+
+void latency_tracker::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_.clear();
+    histograms_.clear();
+    next_expiry_ns_ = 0;
+}
+
+} // namespace framework
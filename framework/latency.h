@@ -0,0 +1,201 @@
+/**
+ * Copyright (C) 2023 Carnegie Mellon University
+ *
+ * This file is part of the Mixnet course project developed for
+ * the Computer Networks course (15-441/641) taught at Carnegie
+ * Mellon University.
+ *
+ * No part of the Mixnet project may be copied and/or distributed
+ * without the express permission of the 15-441/641 course staff.
+ */
+#ifndef FRAMEWORK_LATENCY_H_
+#define FRAMEWORK_LATENCY_H_
+
+#include "mixnet/address.h"
+#include "mixnet/packet.h"
+
+#include <deque>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <time.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace framework {
+
+// Helper macros
+#define DISALLOW_COPY_AND_ASSIGN(TypeName)                  \
+    TypeName(const TypeName&) = delete;                     \
+    void operator=(const TypeName&) = delete
+
+/**
+ * Returns the current CLOCK_MONOTONIC time (in ns). Since every
+ * fragment runs on the same host, these timestamps are comparable
+ * across processes.
+ */
+inline uint64_t monotonic_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL) +
+            static_cast<uint64_t>(ts.tv_nsec));
+}
+
+/**
+ * Log-linear histogram of non-negative values. Every power-of-two
+ * range is split into NUM_SUB_BUCKETS linear buckets, bounding the
+ * relative error of any reported value by 1/NUM_SUB_BUCKETS.
+ */
+class latency_histogram final {
+public:
+    // Constant parameters
+    static constexpr uint32_t SUB_BUCKET_BITS = 4;
+    static constexpr uint32_t NUM_SUB_BUCKETS = (1 << SUB_BUCKET_BITS);
+    static constexpr uint32_t NUM_BUCKETS = (
+        (64 - SUB_BUCKET_BITS + 1) * NUM_SUB_BUCKETS);
+
+private:
+    std::vector<uint64_t> counts_;                      // Bucket ID -> Count
+    uint64_t count_ = 0;                                // Number of samples
+    uint64_t sum_ = 0;                                  // Sum of samples
+    uint64_t min_ = UINT64_MAX;                         // Smallest sample
+    uint64_t max_ = 0;                                  // Largest sample
+
+    static uint32_t bucket_index(const uint64_t value);
+    static uint64_t bucket_lower_bound(const uint32_t index);
+
+public:
+    explicit latency_histogram() : counts_(NUM_BUCKETS, 0) {}
+
+    void record(const uint64_t value);
+
+    // Adds every sample recorded in the other histogram
+    void merge(const latency_histogram& other);
+
+    // Accessors
+    uint64_t count() const { return count_; }
+    uint64_t min() const { return ((count_ == 0) ? 0 : min_); }
+    uint64_t max() const { return max_; }
+    uint64_t mean() const { return ((count_ == 0) ? 0 : (sum_ / count_)); }
+
+    /**
+     * Returns the (approximate) value at the given percentile, which
+     * must lie in [0, 100]. Returns 0 if the histogram is empty.
+     */
+    uint64_t percentile(const double p) const;
+};
+
+/**
+ * Tracks the one-way (injection to delivery) latency of packets that
+ * the orchestrator injects. Packets carry no identifiers end-to-end,
+ * so injections are matched with deliveries on (source, destination,
+ * type, payload digest), in FIFO order; either event may be observed
+ * first. Latencies are accumulated into per-flow (i.e., per source-
+ * destination pair) histograms. Thread-safe.
+ *
+ * Some events never find a match (e.g., DATA packets sent to nodes
+ * that aren't captured, or deliveries of packets that the nodes
+ * generated themselves), so unmatched events are bounded per key,
+ * and expire after a while.
+ */
+class latency_tracker final {
+public:
+    typedef std::pair<mixnet_address, mixnet_address> flow;
+
+    // Constant parameters
+    static constexpr size_t MAX_PENDING_EVENTS = 1024;  // Per key and event type
+    static constexpr uint64_t MAX_INJECTION_AGE_NS = (  // Unmatched injections
+        10 * 1000000000ULL);                            // (i.e., lost packets)
+    static constexpr uint64_t MAX_DELIVERY_AGE_NS = (   // Unmatched deliveries
+        1000000000ULL);                                 // (racing injections)
+    static constexpr uint64_t EXPIRY_INTERVAL_NS = (    // Time between expiry
+        1000000000ULL);                                 // sweeps
+
+private:
+    // Key used to match injections with deliveries
+    struct match_key {
+        mixnet_address src;
+        mixnet_address dst;
+        mixnet_packet_type_t type;
+        uint64_t digest;
+
+        bool operator==(const match_key& other) const {
+            return ((src == other.src) && (dst == other.dst) &&
+                    (type == other.type) && (digest == other.digest));
+        }
+    };
+    struct match_key_hash {
+        size_t operator()(const match_key& key) const {
+            return (key.digest ^ ((static_cast<uint64_t>(key.src) << 32) |
+                                  (static_cast<uint64_t>(key.dst) << 16) |
+                                  key.type));
+        }
+    };
+    // Unmatched event timestamps for a key
+    struct pending_events {
+        std::deque<uint64_t> injected;
+        std::deque<uint64_t> delivered;
+    };
+
+    mutable std::mutex mutex_;                          // Guards the state below
+    std::unordered_map<match_key, pending_events,
+                       match_key_hash> pending_;        // Key -> Unmatched events
+    std::map<flow, latency_histogram> histograms_;      // Flow -> Latency histogram
+    uint64_t next_expiry_ns_ = 0;                       // Next expiry sweep
+    std::string tag_{};                                 // Tracked payload prefix
+
+    static uint64_t digest(const char *data, const size_t length);
+    bool is_tagged(const mixnet_packet_type_t type, const char *data,
+                   const size_t length) const;
+    void expire(const uint64_t now_ns);
+    void match(const match_key& key, const uint64_t timestamp_ns,
+               const bool is_injection);
+
+public:
+    DISALLOW_COPY_AND_ASSIGN(latency_tracker);
+    explicit latency_tracker() = default;
+
+    /**
+     * Restricts tracking to DATA packets whose payload starts with the
+     * given tag (if empty, tracks every packet). Untagged packets are
+     * skipped before any locking or hashing, so traffic that is never
+     * injected (e.g., node-generated load) costs next to nothing. Not
+     * thread-safe; set the tag before recording any events.
+     */
+    void set_tag(const std::string& tag) { tag_ = tag; }
+
+    /**
+     * Records the injection of a packet with the given parameters.
+     * Only DATA and PING packets are tracked.
+     */
+    void on_inject(const mixnet_address src, const mixnet_address dst,
+                   const mixnet_packet_type_t type, const char *data,
+                   const size_t data_length, const uint64_t timestamp_ns);
+
+    /**
+     * Records the delivery of a (complete, valid) packet on a user
+     * port. Packets that cannot have been injected are ignored.
+     */
+    void on_deliver(const mixnet_packet *const packet,
+                    const uint64_t timestamp_ns);
+
+    // Returns a copy of the per-flow histograms
+    std::map<flow, latency_histogram> histograms() const;
+
+    // Prints per-flow latency percentiles (in us)
+    void report(std::ostream& os) const;
+
+    // Discards all recorded state
+    void clear();
+};
+
+// Cleanup
+#undef DISALLOW_COPY_AND_ASSIGN
+
+} // namespace framework
+
+#endif // FRAMEWORK_LATENCY_H_
@@ -118,16 +118,23 @@ message::length_t message::compute_total_length() const {
         );
     } break;
 
+    case type::CHANGE_LINK_STATE_BATCH: {
+        length = (request ?
+            payload<request::change_link_state_batch>()->length() :
+            0
+        );
+    } break;
+
     case type::PCAP_DATA: {
         length = (request ?
             0 :
-            payload<mixnet_packet>()->total_size
+            payload<response::pcap_data>()->length()
         );
     } break;
 
     case type::PCAP_SUBSCRIPTION: {
         length = (request ?
-            request::pcap_subscription::length() :
+            payload<request::pcap_subscription>()->length() :
             0
         );
     } break;
@@ -135,13 +142,41 @@ message::length_t message::compute_total_length() const {
     case type::SEND_PACKET: {
         length = (request ?
             payload<request::send_packet>()->length() :
+            response::send_packet::length()
+        );
+    } break;
+
+    case type::SEND_PACKET_BATCH: {
+        length = (request ?
+            payload<request::send_packet_batch>()->length() :
+            payload<response::send_packet_batch>()->length()
+        );
+    } break;
+
+    case type::TRAFFIC_PROFILE: {
+        length = (request ?
+            payload<request::traffic_profile>()->length() :
             0
         );
     } break;
 
+    case type::CONVERGENCE_STATUS: {
+        length = (request ?
+            0 :
+            response::convergence_status::length()
+        );
+    } break;
+
+    case type::END_TESTCASE: {
+        length = (request ?
+            0 :
+            response::end_testcase::length()
+        );
+    } break;
+
     case type::START_TESTCASE:
-    case type::END_TESTCASE:
-    case type::SHUTDOWN: {
+    case type::SHUTDOWN:
+    case type::RESET: {
         length = 0;
     }
     break;
@@ -12,6 +12,9 @@
 #define FRAMEWORK_MESSAGE_H_
 
 #include "error.h"
+#include "networking.h"
+#include "pcap_filter.h"
+#include "traffic_profile.h"
 #include "mixnet/address.h"
 #include "mixnet/packet.h"
 
@@ -63,12 +66,17 @@ public:
         START_MIXNET_CLIENTS,                   // Start Mixnet clients
         RESOLVE_MIXNET_CONNS,                   // Resolve Mixnet connections
         CHANGE_LINK_STATE,                      // Change network link states
+        CHANGE_LINK_STATE_BATCH,                // Change a batch of link states
         PCAP_DATA,                              // Fragment-captured pcap data
         PCAP_SUBSCRIPTION,                      // Change subscription to pcaps
         SEND_PACKET,                            // Send a packet on the network
+        SEND_PACKET_BATCH,                      // Send a batch of packets
+        TRAFFIC_PROFILE,                        // Start local traffic generation
+        CONVERGENCE_STATUS,                     // Query node-reported state
         START_TESTCASE,                         // Indicate testcase commencing
         END_TESTCASE,                           // Indicate testcase completion
         SHUTDOWN,                               // Teardown the fragment process
+        RESET,                                  // Prepare for another testcase
 
         ENUMERATION_LIMIT,                      // Sentinel value (DO NOT TOUCH)
     };
@@ -159,6 +167,9 @@ public:
         // Setup ctrl overlay
         struct setup_ctrl {
             bool autotest_mode;                 // Use autotest mode?
+            networking::backend link_backend;   // I/O backend for Mixnet links
+            networking::transport link_transport; // Transport for Mixnet links
+            uint16_t num_io_threads;            // I/O threads (IO_THREADS backend)
 
             // Helper methods
             GENERATE_POD_LENGTH_DEFN(setup_ctrl)
@@ -181,6 +192,12 @@ public:
             uint32_t root_hello_interval_ms;    // Time between 'hello' messages
             uint32_t reelection_interval_ms;    // Time before starting reelection
 
+            // Capture configuration
+            uint32_t pcap_queue_depth;          // Capture queue depth
+            uint16_t pcap_block_timeout_ms;     // Timeout for pcap_overflow::BLOCK
+            pcap_overflow pcap_overflow_policy; // Capture queue overflow policy
+            uint8_t padding_[1]{};              // Padding for pointer alignment
+
             // NID -> Cost of routing on the link
             uint16_t *link_costs() {
                 return reinterpret_cast<uint16_t*>(
@@ -238,13 +255,48 @@ public:
             // Helper methods
             GENERATE_POD_LENGTH_DEFN(change_link_state)
         };
-        // Change pcap subscription
+        // Change a batch of network link states
+        struct change_link_state_batch {
+            uint16_t num_changes;               // Number of change records
+            uint8_t padding_[6]{};              // Padding for pointer alignment
+
+            // Change records, applied in order
+            change_link_state *changes() {
+                return reinterpret_cast<change_link_state*>(
+                    reinterpret_cast<char*>(this) + sizeof(*this));
+            }
+            // Helper methods
+            length_t length() const {
+                return (sizeof(*this) +
+                        (num_changes * sizeof(change_link_state)));
+            }
+        };
+        CHECK_SIZE_VLA_PTR_ALIGN(change_link_state_batch);
+
+        // Change pcap subscription (see pcap_filter.h)
         struct pcap_subscription {
             bool subscribe;                     // Whether to subscribe/unsubscribe
                                                 // to/from the fragment's pcap data.
+            uint8_t padding_1_[1]{};            // Padding for field alignment
+            uint16_t type_mask;                 // Packet types to capture (bitmask)
+            uint16_t sample_rate;               // Capture 1-in-N matching packets
+            uint16_t snaplen;                   // Max captured size (0: unlimited)
+            uint16_t num_src_addrs;             // Size of the source address set
+            uint16_t num_dst_addrs;             // Size of the destination address set
+            uint8_t padding_2_[4]{};            // Padding for pointer alignment
+
+            // Source addresses, followed by destination addresses
+            mixnet_address *addrs() {
+                return reinterpret_cast<mixnet_address*>(
+                    reinterpret_cast<char*>(this) + sizeof(*this));
+            }
             // Helper methods
-            GENERATE_POD_LENGTH_DEFN(pcap_subscription)
+            length_t length() const {
+                return (sizeof(*this) + ((num_src_addrs + num_dst_addrs) *
+                                         sizeof(mixnet_address)));
+            }
         };
+        CHECK_SIZE_VLA_PTR_ALIGN(pcap_subscription);
         // Send a packet out over the network
         struct send_packet {
             mixnet_packet_type_t type;          // Packet type
@@ -260,8 +312,64 @@ public:
                 return (sizeof(*this) +
                         (data_length * sizeof(char)));
             }
+            // Next record in a send_packet_batch
+            send_packet *next() {
+                return reinterpret_cast<send_packet*>(
+                    reinterpret_cast<char*>(this) + size(data_length));
+            }
+            static size_t size(const uint16_t data_length) {
+                return (sizeof(send_packet) + ((data_length + 7) & ~7));
+            }
         };
         CHECK_SIZE_VLA_PTR_ALIGN(send_packet);
+
+        // Send a batch of packets out over the network
+        struct send_packet_batch {
+            uint16_t num_packets;               // Number of packet records
+            uint16_t packets_length;            // Total size of the records (bytes)
+            uint8_t padding_[4]{};              // Padding for pointer alignment
+
+            // Each record is a send_packet (with data), padded to
+            // preserve the alignment of subsequent records.
+            send_packet *packets() {
+                return reinterpret_cast<send_packet*>(
+                    reinterpret_cast<char*>(this) + sizeof(*this));
+            }
+            // Helper methods
+            length_t length() const { return (sizeof(*this) + packets_length); }
+        };
+        CHECK_SIZE_VLA_PTR_ALIGN(send_packet_batch);
+
+        // Generate traffic locally (see traffic_profile.h)
+        struct traffic_profile {
+            mixnet_packet_type_t type;          // DATA or PING
+            traffic_arrival arrival;            // Inter-arrival process
+            uint8_t padding_1_[1]{};            // Padding for field alignment
+            uint32_t rate_pps;                  // Mean rate (0: saturate)
+            uint32_t duration_ms;               // Generation period
+            uint32_t seed;                      // PRNG seed (0: random)
+            uint16_t min_data_length;           // Smallest payload (DATA only)
+            uint16_t max_data_length;           // Largest payload (DATA only)
+            uint16_t num_dsts;                  // Size of the destination set
+            uint8_t padding_2_[2]{};            // Padding for pointer alignment
+
+            struct destination {
+                mixnet_address mixaddr;         // Destination Mixnet address
+                uint8_t padding_[2]{};          // Padding for field alignment
+                uint32_t weight;                // Relative weight
+            };
+            // Destination set
+            destination *dsts() {
+                return reinterpret_cast<destination*>(
+                    reinterpret_cast<char*>(this) + sizeof(*this));
+            }
+            // Helper methods
+            length_t length() const {
+                return (sizeof(*this) +
+                        (num_dsts * sizeof(destination)));
+            }
+        };
+        CHECK_SIZE_VLA_PTR_ALIGN(traffic_profile);
     };
 
     /**
@@ -299,6 +407,95 @@ public:
                                               (num_neighbors * sizeof(sockaddr_in))); }
         };
         CHECK_SIZE_VLA_PTR_ALIGN(start_mixnet_clients);
+
+        // Send a packet out over the network
+        struct send_packet {
+            uint64_t timestamp_ns;              // Injection time (CLOCK_MONOTONIC)
+
+            // Helper methods
+            GENERATE_POD_LENGTH_DEFN(send_packet)
+        };
+        // Send a batch of packets out over the network
+        struct send_packet_batch {
+            uint16_t num_packets;               // Number of packets injected
+            uint8_t padding_[6]{};              // Padding for pointer alignment
+
+            // Injection time of each packet (CLOCK_MONOTONIC)
+            uint64_t *timestamps_ns() {
+                return reinterpret_cast<uint64_t*>(
+                    reinterpret_cast<char*>(this) + sizeof(*this));
+            }
+            // Helper methods
+            length_t length() const {
+                return (sizeof(*this) +
+                        (num_packets * sizeof(uint64_t)));
+            }
+        };
+        CHECK_SIZE_VLA_PTR_ALIGN(send_packet_batch);
+
+        // Query node-reported state and counters (see mixnet_
+        // report_state() and mixnet_report_counters())
+        struct convergence_status {
+            mixnet_address root_address;        // STP root
+            uint16_t path_length;               // Path length to the root
+            mixnet_address next_hop;            // Next hop towards the root
+            uint16_t lsdb_size;                 // Nodes in the link-state DB
+            uint64_t stable_ns;                 // Time since the last change
+            uint64_t last_change_ns;            // Node start -> Last change
+            uint64_t stp_packets_sent;          // STP packets sent
+            uint64_t lsa_packets_sent;          // LSA packets sent
+            uint64_t spf_runs;                  // Path computations
+            bool has_reported;                  // Any state reported yet?
+
+            // Helper methods
+            GENERATE_POD_LENGTH_DEFN(convergence_status)
+        };
+        // End testcase
+        struct end_testcase {
+            uint64_t pcap_drops;                // Captured packets dropped on overflow
+            uint64_t traffic_sent;              // Generated packets injected
+            uint64_t traffic_drops;             // Generated packets dropped
+            uint64_t traffic_duration_ns;       // Time spent generating traffic
+
+            // Helper methods
+            GENERATE_POD_LENGTH_DEFN(end_testcase)
+        };
+        // Captured pcap data (a batch of packet records)
+        struct pcap_data {
+            uint16_t num_records;               // Number of packet records
+            uint16_t records_length;            // Total size of the records (bytes)
+            uint8_t padding_[4]{};              // Padding for pointer alignment
+
+            // Each record is a header followed by the captured packet,
+            // padded to preserve the alignment of subsequent records.
+            struct record {
+                uint16_t caplen;                // Size of the captured packet
+                uint8_t padding_[6]{};          // Padding for pointer alignment
+                uint64_t timestamp_ns;          // Delivery time (CLOCK_MONOTONIC)
+
+                // Helper methods
+                mixnet_packet *packet() {
+                    return reinterpret_cast<mixnet_packet*>(
+                        reinterpret_cast<char*>(this) + sizeof(*this));
+                }
+                record *next() {
+                    return reinterpret_cast<record*>(
+                        reinterpret_cast<char*>(this) + size(caplen));
+                }
+                static size_t size(const uint16_t caplen) {
+                    return (sizeof(record) + ((caplen + 7) & ~7));
+                }
+            };
+            CHECK_SIZE_VLA_PTR_ALIGN(record);
+
+            // Helper methods
+            record *records() {
+                return reinterpret_cast<record*>(
+                    reinterpret_cast<char*>(this) + sizeof(*this));
+            }
+            length_t length() const { return (sizeof(*this) + records_length); }
+        };
+        CHECK_SIZE_VLA_PTR_ALIGN(pcap_data);
     };
 };
 
@@ -12,12 +12,17 @@
 
 #include "message.h"
 
+#include <algorithm>
 #include <assert.h>
 #include <chrono>
 #include <errno.h>
 #include <fcntl.h>
 #include <poll.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
 #include <sys/socket.h>
+#include <sys/un.h>
 #include <unistd.h>
 
 namespace framework {
@@ -27,6 +32,10 @@ namespace networking {
 using namespace std::chrono;
 typedef high_resolution_clock clock;
 
+// Upper bound on how long server_accept() blocks at a time (in
+// ms), which bounds the latency with which it sees keep_running.
+static constexpr uint64_t ACCEPT_POLL_INTERVAL_MS = 10;
+
 accept_args::accept_args(
     const int fd, const bool use_timeout,
     const uint64_t timeout, const uint16_t max_clients) :
@@ -58,6 +67,100 @@ int socket(const bool reuse_addr, bool is_blocking) {
     return success ? socket_fd : -1;
 }
 
+/**
+ * Helper functions. Encode/decode a local endpoint ID (sockaddr_in)
+ * to/from its abstract AF_UNIX address. Abstract paths begin with a
+ * NUL byte, and their length is determined by the addrlen argument.
+ */
+static socklen_t encode_local_netaddr(const sockaddr_in& id,
+                                      sockaddr_un *const addr) {
+    memset(addr, 0, sizeof(sockaddr_un));
+    addr->sun_family = AF_UNIX;
+    const int len = snprintf(addr->sun_path + 1,
+        sizeof(addr->sun_path) - 1, "mixnet-%08x-%04x",
+        ntohl(id.sin_addr.s_addr), ntohs(id.sin_port));
+
+    return static_cast<socklen_t>(
+        offsetof(sockaddr_un, sun_path) + 1 + len);
+}
+
+static bool decode_local_netaddr(const sockaddr_un& addr,
+    const socklen_t addrlen, sockaddr_in *const id) {
+    const size_t path_offset = offsetof(sockaddr_un, sun_path);
+    if ((addr.sun_family != AF_UNIX) ||
+        (addrlen <= (path_offset + 1)) ||
+        (addr.sun_path[0] != '\0')) { return false; }
+
+    // Copy out the (unterminated) abstract path
+    char path[sizeof(addr.sun_path)] = {};
+    memcpy(path, addr.sun_path + 1, addrlen - path_offset - 1);
+
+    unsigned int s_addr = 0, port = 0;
+    if (sscanf(path, "mixnet-%08x-%04x", &s_addr, &port) != 2) {
+        return false;
+    }
+    memset(id, 0, sizeof(sockaddr_in));
+    id->sin_family = AF_INET;
+    id->sin_port = htons(static_cast<uint16_t>(port));
+    id->sin_addr.s_addr = htonl(static_cast<uint32_t>(s_addr));
+    return true;
+}
+
+/**
+ * Initializes a local (AF_UNIX, SOCK_SEQPACKET) socket.
+ */
+int local_socket(bool is_blocking) {
+    const int type = (SOCK_SEQPACKET | (is_blocking ? 0 : SOCK_NONBLOCK));
+    return ::socket(AF_UNIX, type, 0);
+}
+
+/**
+ * Performs local server setup (socket, bind, listen).
+ */
+error_code local_server_setup(int *socket_fd, const sockaddr_in& id,
+                              const int queue) {
+    // No clients, nothing to do
+    if (queue == 0) { return error_code::NONE; }
+
+    // Set up a socket to listen for connections
+    if ((*socket_fd = local_socket(false)) < 0) {
+        return error_code::SOCKET_CREATE_FAILED;
+    }
+    // Bind to the abstract path
+    if (local_bind(*socket_fd, id) < 0) {
+        return error_code::SOCKET_BIND_FAILED;
+    }
+    // Prepare to listen for connection attempts
+    if (listen(*socket_fd, queue) < 0) {
+        return error_code::SOCKET_LISTEN_FAILED;
+    }
+    return error_code::NONE;
+}
+
+/**
+ * Binds a local socket to the abstract path for the given ID.
+ */
+int local_bind(const int socket_fd, const sockaddr_in& id) {
+    sockaddr_un addr;
+    const socklen_t addrlen = encode_local_netaddr(id, &addr);
+    return bind(socket_fd, (sockaddr *) &addr, addrlen);
+}
+
+/**
+ * Connects a local socket to the server with the given ID. Unlike
+ * TCP, this either completes or fails immediately (the listening
+ * socket must already exist). Returns 0 on success, -1 on error.
+ */
+int local_connect(const int socket_fd, const sockaddr_in& id) {
+    sockaddr_un addr;
+    const socklen_t addrlen = encode_local_netaddr(id, &addr);
+
+    int rc = -1;
+    do { rc = connect(socket_fd, (sockaddr *) &addr, addrlen); }
+    while ((rc < 0) && (errno == EINTR));
+    return (rc < 0) ? -1 : 0;
+}
+
 /**
  * Performs standard server setup (socket, bind, listen).
  */
@@ -115,20 +218,42 @@ void server_accept(accept_args& args) {
     while ((args.num_accepted < args.max_clients) &&
            (args.rc == 0) && args.keep_running) {
 
+        uint64_t wait_ms = ACCEPT_POLL_INTERVAL_MS;
         if (args.use_timeout) {
             // Exhausted the timeout for connect
             auto delta_ms = get_time_ms_since(start);
             if (delta_ms >= args.timeout_ms) { break; }
+            wait_ms = std::min(wait_ms, (args.timeout_ms - delta_ms));
+        }
+        // Wait for a connection attempt (rather than spinning on accept)
+        pollfd pfd; // Set up polling on the listening fd
+        pfd.fd = args.listen_fd; pfd.events = POLLIN;
+        int rc = poll(&pfd, 1, static_cast<int>(wait_ms));
+        if (rc <= 0) {
+            if ((rc < 0) && (errno != EINTR)) { args.rc = -1; }
+            continue;
         }
         // Accept incoming requests
         accepted_state *const state = &(
             args.states[args.num_accepted]);
 
         state->connection_fd = -1;
-        state->addrlen = sizeof(sockaddr_in);
+        sockaddr_storage address;
+        socklen_t addrlen = sizeof(address);
         int retval = accept(args.listen_fd,
-                            (sockaddr *) &(state->address),
-                            &(state->addrlen));
+                            (sockaddr *) &address, &addrlen);
+
+        // Translate local (AF_UNIX) peers back to their IDs
+        if ((retval >= 0) && (address.ss_family == AF_UNIX)) {
+            if (!decode_local_netaddr(*reinterpret_cast<
+                sockaddr_un*>(&address), addrlen, &(state->address))) {
+                close(retval); args.rc = -1; continue;
+            }
+        }
+        else if (retval >= 0) {
+            memcpy(&(state->address), &address, sizeof(sockaddr_in));
+        }
+        state->addrlen = sizeof(sockaddr_in);
         if (retval < 0) {
             // Accept encountered a real error
             if ((errno != EAGAIN) && (errno != EWOULDBLOCK)) {
@@ -205,6 +330,97 @@ int connect_with_timeout(
     return rc;
 }
 
+/**
+ * Concurrent counterpart of connect_with_timeout(). Initiates a non-
+ * blocking connect on every socket, then waits on all of them at once,
+ * so the total time is bounded by the slowest connection (rather than
+ * the sum). Return 0 if every socket connected, -1 on error.
+ */
+int connect_all_with_timeout(const std::vector<int>& socket_fds,
+                             const std::vector<sockaddr_in>& addresses,
+                             const uint64_t timeout_ms) {
+    assert(socket_fds.size() == addresses.size());
+    const size_t num_sockets = socket_fds.size();
+    std::vector<int> flags(num_sockets, -1);
+    std::vector<pollfd> pfds; // Connections in progress
+    int rc = 0; // Return value
+
+    for (size_t idx = 0; (idx < num_sockets) && (rc == 0); idx++) {
+        // First, put the socket into non-blocking mode
+        const int fd = socket_fds[idx];
+        if (((flags[idx] = fcntl(fd, F_GETFL, 0)) < 0) ||
+            (fcntl(fd, F_SETFL, (flags[idx] | O_NONBLOCK)) < 0)) {
+            rc = -1; break;
+        }
+        if (connect(fd, (sockaddr *) &(addresses[idx]),
+                    sizeof(sockaddr_in)) == 0) { continue; }
+
+        // If connect encountered a real error, fail
+        if ((errno != EAGAIN) && (errno != EWOULDBLOCK) &&
+            (errno != EINPROGRESS)) { rc = -1; break; }
+
+        pollfd pfd; // Connection attempt is still in progress
+        pfd.fd = fd; pfd.events = POLLOUT; pfd.revents = 0;
+        pfds.push_back(pfd);
+    }
+    auto start = clock::now();
+    size_t num_pending = pfds.size();
+    while ((rc == 0) && (num_pending != 0)) {
+        // Exhausted the timeout for connect
+        auto delta_ms = get_time_ms_since(start);
+        if (delta_ms >= timeout_ms) { errno = ETIMEDOUT; rc = -1; break; }
+
+        int retval = poll(pfds.data(), pfds.size(),
+                          static_cast<int>(timeout_ms - delta_ms));
+        if (retval < 0) {
+            if (errno != EINTR) { rc = -1; }
+            continue;
+        }
+        for (auto& pfd : pfds) {
+            if ((pfd.fd < 0) || (pfd.revents == 0)) { continue; }
+
+            // Make sure the connection *really* succeeded
+            int error = 0; socklen_t len = sizeof(error);
+            if (getsockopt(pfd.fd, SOL_SOCKET, SO_ERROR,
+                           &error, &len) != 0) { error = errno; }
+            if (error != 0) { errno = error; rc = -1; break; }
+
+            pfd.fd = -1; // Connected, stop polling this socket
+            num_pending--;
+        }
+    }
+    // Finally, restore the original flags
+    for (size_t idx = 0; idx < num_sockets; idx++) {
+        if ((flags[idx] >= 0) &&
+            (fcntl(socket_fds[idx], F_SETFL, flags[idx]) < 0)) { rc = -1; }
+    }
+    return rc;
+}
+
+bool read_full(const int fd, void *buffer, const size_t len) {
+    size_t offset = 0;
+    while (offset < len) {
+        const ssize_t rc = read(fd, (static_cast<char*>(buffer) + offset),
+                                (len - offset));
+        if ((rc < 0) && (errno == EINTR)) { continue; }
+        if (rc <= 0) { return false; }
+        offset += static_cast<size_t>(rc);
+    }
+    return true;
+}
+
+bool write_full(const int fd, const void *buffer, const size_t len) {
+    size_t offset = 0;
+    while (offset < len) {
+        const ssize_t rc = write(fd, (static_cast<const char*>(buffer) +
+                                      offset), (len - offset));
+        if ((rc < 0) && (errno == EINTR)) { continue; }
+        if (rc <= 0) { return false; }
+        offset += static_cast<size_t>(rc);
+    }
+    return true;
+}
+
 /**
  * Given a socket fd, validate config.
  */
@@ -407,6 +623,121 @@ error_code recv_generic<uint16_t>(
     const config, const int, char *,
     const error_code, const uint16_t, const uint16_t);
 
+/**
+ * Generic helper function to send messages on a message-preserving
+ * (SOCK_SEQPACKET) socket. Each message is sent as a single datagram,
+ * so no reassembly is necessary on the receive path.
+ *
+ * @tparam T: Type (e.g., uint8_t) of the leading length field.
+ */
+template<typename T>
+error_code send_datagram(const config config, const int fd,
+    const char *buffer, const error_code connection_error,
+                         const T min_len, const T max_len) {
+    // Sanity checks
+    assert(max_len >= min_len);
+    assert(min_len >= sizeof(T));
+
+    // Validate config
+    auto error_code = validate(fd, config, true);
+    const bool use_timeout = config.use_timeout();
+    if (error_code != error_code::NONE) { return error_code; }
+
+    // Fetch and validate the message length
+    const size_t buffer_len = static_cast<size_t>(
+        (reinterpret_cast<const T*>(buffer))[0]);
+
+    if ((buffer_len < min_len) || (buffer_len > max_len)) {
+        return error_code::MALFORMED_MESSAGE;
+    }
+    uint64_t delta_ms = 0;
+    auto start = clock::now();
+    while (!use_timeout || (delta_ms < config.timeout())) {
+        int rc = send(fd, buffer, buffer_len, MSG_NOSIGNAL);
+        if (rc >= 0) {
+            // Datagrams are sent atomically
+            return (static_cast<size_t>(rc) == buffer_len) ?
+                    error_code::NONE : connection_error;
+        }
+        else if ((errno != EAGAIN) && (errno != EWOULDBLOCK) &&
+                 (errno != ENOBUFS) && (errno != EINTR)) {
+            return connection_error;
+        }
+        if (use_timeout) {
+            delta_ms = get_time_ms_since(start);
+        }
+    }
+    return error_code::SEND_REQS_TIMEOUT;
+}
+
+/**
+ * Generic helper function to receive messages on a message-preserving
+ * (SOCK_SEQPACKET) socket. A single recv() returns exactly one message.
+ *
+ * @tparam T: Type (e.g., uint8_t) of the leading length field.
+ */
+template<typename T>
+error_code recv_datagram(const config config, const int fd,
+    char *buffer, const error_code connection_error, const
+    T min_len, const T max_len) {
+    // Sanity checks
+    assert(max_len >= min_len);
+    assert(min_len >= sizeof(T));
+
+    // Validate config
+    auto error_code = validate(fd, config, false);
+    const bool use_timeout = config.use_timeout();
+    if (error_code != error_code::NONE) { return error_code; }
+
+    uint64_t delta_ms = 0;
+    auto start = clock::now();
+    while (!use_timeout || (delta_ms < config.timeout())) {
+        int rc = recv(fd, buffer, max_len, MSG_TRUNC);
+        if (rc < 0) {
+            if ((errno != EAGAIN) && (errno != EWOULDBLOCK) &&
+                (errno != ENOBUFS) && (errno != EINTR)) {
+                return connection_error;
+            }
+            else if (config.try_once()) {
+                return error_code::RECV_ZERO_PENDING;
+            }
+        }
+        // Socket was closed
+        else if (rc == 0) {
+            return connection_error;
+        }
+        // Ensure the length field agrees with the datagram size
+        // (MSG_TRUNC returns the real size if it was truncated).
+        else {
+            const size_t recv_bytes = static_cast<size_t>(rc);
+            if ((recv_bytes < sizeof(T)) || (recv_bytes > max_len) ||
+                (static_cast<size_t>((reinterpret_cast<T*>(
+                    buffer))[0]) != recv_bytes) ||
+                (recv_bytes < min_len)) {
+                return error_code::MALFORMED_MESSAGE;
+            }
+            return error_code::NONE;
+        }
+        if (use_timeout) {
+            delta_ms = get_time_ms_since(start);
+        }
+    }
+    return error_code::RECV_ZERO_PENDING;
+}
+
+/**
+ * Explicit template instantiation.
+ */
+template
+error_code send_datagram<uint16_t>(
+    const config, const int, const char *,
+    const error_code, const uint16_t, const uint16_t);
+
+template
+error_code recv_datagram<uint16_t>(
+    const config, const int, char *,
+    const error_code, const uint16_t, const uint16_t);
+
 /**
  * Returns whether two network addresses are identical.
  */
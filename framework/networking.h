@@ -16,6 +16,7 @@
 #include <memory>
 #include <netinet/in.h>
 #include <stdint.h>
+#include <vector>
 
 namespace framework {
 namespace networking {
@@ -77,6 +78,24 @@ enum class mode {
     RX_TX_BLOCKING = 0, RX_TX_TIMEOUT, RX_TRY_ONCE,
 };
 
+/**
+ * I/O backends for Mixnet links between nodes. IO_URING falls
+ * back to SOCKET if unsupported by the build or the kernel, as
+ * does IO_THREADS (dedicated I/O threads) if they can't start.
+ */
+enum class backend : uint8_t {
+    SOCKET = 0, IO_URING, IO_THREADS,
+};
+
+/**
+ * Transports for Mixnet links between nodes. UNIX_SEQPACKET uses
+ * message-preserving AF_UNIX sockets (in the abstract namespace),
+ * so it is only usable if every node runs on the same host.
+ */
+enum class transport : uint8_t {
+    TCP = 0, UNIX_SEQPACKET,
+};
+
 /**
  * Config for RX/TX functions.
  */
@@ -107,6 +126,31 @@ int connect_with_timeout(
     const int socket_fd, const sockaddr_in *const addr,
     const socklen_t addrlen, const uint64_t timeout_ms);
 
+int connect_all_with_timeout(const std::vector<int>& socket_fds,
+                             const std::vector<sockaddr_in>& addresses,
+                             const uint64_t timeout_ms);
+
+/**
+ * Local (AF_UNIX, SOCK_SEQPACKET) counterparts of the above. Local
+ * endpoints are still identified by a sockaddr_in (e.g., the node's
+ * PID and a port number), which is encoded into an abstract path.
+ */
+int local_socket(const bool is_blocking);
+
+error_code local_server_setup(
+    int *socket_fd, const sockaddr_in& id, const int listen_queue);
+
+int local_bind(const int socket_fd, const sockaddr_in& id);
+
+int local_connect(const int socket_fd, const sockaddr_in& id);
+
+/**
+ * Blocking helpers to transfer exactly len bytes on a stream FD (e.g.,
+ * a pipe). Return false on error, or if the peer hangs up.
+ */
+bool read_full(const int fd, void *buffer, const size_t len);
+bool write_full(const int fd, const void *buffer, const size_t len);
+
 template<typename T>
 error_code send_generic(const config config, const int fd,
     const char *buffer, const error_code connection_error,
@@ -117,6 +161,16 @@ error_code recv_generic(const config config, const int fd,
     char *buffer, const error_code connection_error, const
     T min_len, const T max_len);
 
+template<typename T>
+error_code send_datagram(const config config, const int fd,
+    const char *buffer, const error_code connection_error,
+                         const T min_len, const T max_len);
+
+template<typename T>
+error_code recv_datagram(const config config, const int fd,
+    char *buffer, const error_code connection_error, const
+    T min_len, const T max_len);
+
 bool equal_netaddrs(const sockaddr_in addr_a,
                     const sockaddr_in addr_b);
 
@@ -12,16 +12,24 @@
 
 #include "message.h"
 #include "networking.h"
+#include "validation.h"
 #include "testing/common/testcase.h"
 
+#include <algorithm>
 #include <assert.h>
 #include <chrono>
+#include <errno.h>
+#include <fcntl.h>
 #include <filesystem>
 #include <iostream>
+#include <map>
 #include <memory>
-#include <poll.h>
 #include <signal.h>
+#include <spawn.h>
 #include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
 #include <unistd.h>
 
 namespace framework {
@@ -142,38 +150,233 @@ error_code orchestrator::foreach_fragment_send_ctrl(
                                          error_code::CTRL_CONNECTION_BROKEN);
 }
 
+/**
+ * Helper methods to launch fragment processes.
+ */
+std::vector<std::string> orchestrator::fragment_command_line() const {
+    std::vector<std::string> args = {
+        (fragment_dir_ + "/node"),                  // 0: Executable path
+        "127.0.0.1",                                // 1: Loopback IP
+        std::to_string(listen_port_ctrl_),          // 2: Server port
+    };
+    // Optional: Local pcapng capture
+    if (!pcapng_dir_.empty()) {
+        args.push_back("--pcapng");
+        args.push_back(pcapng_dir_);
+        if (pcapng_links_) { args.push_back("--pcapng-links"); }
+    }
+    return args;
+}
+
+// Launches a process with the given command line. Unlike fork() and
+// exec(), posix_spawn() doesn't duplicate the orchestrator's address
+// space (which may be large) only to immediately discard it.
+static pid_t spawn_process(const std::vector<std::string>& args) {
+    std::vector<char*> argv;
+    for (const auto& arg : args) {
+        argv.push_back(const_cast<char*>(arg.c_str()));
+    }
+    argv.push_back(NULL);
+
+    pid_t pid = -1;
+    if (posix_spawn(&pid, argv[0], NULL, NULL,
+                    argv.data(), environ) != 0) { return -1; }
+    return pid;
+}
+
+error_code orchestrator::spawn_fragments(const uint16_t num_fragments) {
+    const auto args = fragment_command_line();
+    for (uint16_t idx = 0; idx < num_fragments; idx++) {
+        const pid_t pid = spawn_process(args);
+        if (pid < 0) { return error_code::EXEC_FAILED; }
+
+        fragments_.push_back(fragment_metadata());
+        fragments_.back().pid = pid;
+    }
+    return error_code::NONE;
+}
+
+error_code
+orchestrator::spawn_fragments_zygote(const uint16_t num_fragments) {
+    // The zygote is a fragment process that, once loaded and initialized,
+    // forks ready-to-run fragments on request. Requests (a fragment count)
+    // and replies (the children's PIDs) are exchanged on a socketpair.
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+        return error_code::SOCKET_CREATE_FAILED;
+    }
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC); // Only the zygote's end is inherited
+
+    auto args = fragment_command_line();
+    args.push_back("--zygote");
+    args.push_back(std::to_string(fds[1]));
+
+    const pid_t zygote_pid = spawn_process(args);
+    close(fds[1]);
+    if (zygote_pid < 0) {
+        close(fds[0]); return error_code::EXEC_FAILED;
+    }
+    // Request every fragment at once, then collect their PIDs
+    const uint32_t count = num_fragments;
+    std::vector<pid_t> pids(num_fragments, -1);
+    bool success = (
+        networking::write_full(fds[0], &count, sizeof(count)) &&
+        networking::read_full(fds[0], pids.data(), (pids.size() *
+                                                    sizeof(pid_t))));
+
+    // Hang up; the zygote exits, and its children are reparented
+    close(fds[0]);
+    waitpid(zygote_pid, NULL, 0);
+
+    for (const pid_t pid : pids) {
+        if (pid < 0) { success = false; continue; }
+        fragments_.push_back(fragment_metadata());
+        fragments_.back().pid = pid;
+    }
+    return (success ? error_code::NONE : error_code::FORK_FAILED);
+}
+
+/**
+ * Control-plane fan-out. Requests are serialized up-front and pushed
+ * out without blocking on any one fragment; responses are reassembled
+ * incrementally as bytes arrive. A single epoll loop then drives all
+ * in-flight transfers, so a slow fragment delays only its own message
+ * rather than every fragment queued behind it.
+ */
+struct ctrl_transfer {
+    std::vector<char> buffer;                           // Message bytes
+    size_t offset = 0;                                  // Bytes sent/recv'd so far
+    bool done = false;                                  // Transfer complete?
+};
+
+// Returns whether the errno of a failed send/recv is transient
+static bool is_transient_errno() {
+    return ((errno == EAGAIN) || (errno == EWOULDBLOCK) ||
+            (errno == ENOBUFS) || (errno == EINTR));
+}
+
+// Sends as much of the transfer as possible without blocking
+static error_code try_send(const int fd, ctrl_transfer& xfer,
+                           const error_code connection_error) {
+    while (xfer.offset < xfer.buffer.size()) {
+        int rc = send(fd, xfer.buffer.data() + xfer.offset,
+                      xfer.buffer.size() - xfer.offset,
+                      MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (rc < 0) {
+            return (is_transient_errno() ?
+                    error_code::NONE : connection_error);
+        }
+        xfer.offset += static_cast<size_t>(rc);
+    }
+    xfer.done = true;
+    return error_code::NONE;
+}
+
+// Receives as much of the transfer as possible without blocking
+static error_code try_recv(const int fd, ctrl_transfer& xfer,
+                           const error_code connection_error) {
+    constexpr size_t header_size = sizeof(message::length_t);
+    if (xfer.buffer.empty()) { xfer.buffer.resize(header_size); }
+
+    while (xfer.offset < xfer.buffer.size()) {
+        int rc = recv(fd, xfer.buffer.data() + xfer.offset,
+                      xfer.buffer.size() - xfer.offset, MSG_DONTWAIT);
+        if (rc < 0) {
+            return (is_transient_errno() ?
+                    error_code::NONE : connection_error);
+        }
+        else if (rc == 0) { return connection_error; } // Socket was closed
+        xfer.offset += static_cast<size_t>(rc);
+
+        // Decoded the length prefix, grow the buffer to fit the message
+        if (xfer.offset == header_size) {
+            message::length_t length;
+            memcpy(&length, xfer.buffer.data(), header_size);
+            if ((length < message::MIN_MESSAGE_LENGTH) ||
+                (length > message::MAX_MESSAGE_LENGTH)) {
+                return error_code::MALFORMED_MESSAGE;
+            }
+            xfer.buffer.resize(length);
+        }
+    }
+    xfer.done = true;
+    return error_code::NONE;
+}
+
 error_code orchestrator::foreach_fragment_send_generic(
     const std::vector<int>& fds, const message::type type,
     const std::function<void(const uint16_t, message&)>&
         lambda, const error_code connection_error) {
     auto error_code = error_code::NONE; // Return value
     prepare_header(msg_ctrl_, 0, type); // Common header
-    uint16_t num_pending = fds.size();
-
-    auto start = clock::now();
-    int64_t timer = timeout_communication_ms_;
-    auto deadline = start + milliseconds(timer);
+    const size_t num_fds = fds.size();
+    size_t num_pending = 0;
 
-    // Attempt to send message to every fragment
-    for (size_t idx = 0; (idx < fds.size()) &&
-                         (timer > 0); idx++) {
+    // Serialize every request, then attempt to send it right away
+    std::vector<ctrl_transfer> xfers(num_fds);
+    for (size_t idx = 0; idx < num_fds; idx++) {
 
         // Update fragment ID and payload
         msg_ctrl_.set_fragment_id(idx);
         lambda(idx, msg_ctrl_);
         msg_ctrl_.finalize();
 
-        auto ec = send_with_timeout(fds[idx],
-            msg_ctrl_, timer, connection_error);
+        const char *buffer = msg_ctrl_.buffer();
+        xfers[idx].buffer.assign(buffer, buffer +
+            msg_ctrl_.get_total_length());
+
+        auto ec = try_send(fds[idx], xfers[idx], connection_error);
+        if (ec != error_code::NONE) { xfers[idx].done = true; }
+        if (!xfers[idx].done) { num_pending++; }
 
         // Accumulate errors across iterations
         if (error_code == error_code::NONE) {
             error_code = ec;
         }
-        num_pending--;
+    }
+    if (num_pending == 0) { return error_code; }
+
+    // Some sockets were full, wait for them to drain
+    int epoll_fd = epoll_create1(0);
+    if (epoll_fd < 0) { return error_code::POLL_ERROR; }
+    for (size_t idx = 0; idx < num_fds; idx++) {
+        if (xfers[idx].done) { continue; }
+
+        epoll_event event{};
+        event.events = EPOLLOUT;
+        event.data.u32 = static_cast<uint32_t>(idx);
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fds[idx], &event) < 0) {
+            close(epoll_fd); return error_code::POLL_ERROR;
+        }
+    }
+    auto start = clock::now();
+    int64_t timer = timeout_communication_ms_;
+    auto deadline = start + milliseconds(timer);
+    std::vector<epoll_event> events(num_pending);
+
+    while ((num_pending != 0) && (timer > 0)) {
+        int rc = epoll_wait(epoll_fd, events.data(),
+                            events.size(), timer);
+        for (int i = 0; i < rc; i++) {
+            const uint32_t idx = events[i].data.u32;
+            auto ec = (((events[i].events & (EPOLLERR | EPOLLHUP)) != 0) ?
+                connection_error : try_send(fds[idx], xfers[idx],
+                                            connection_error));
+
+            if (ec != error_code::NONE) { xfers[idx].done = true; }
+            if (xfers[idx].done) {
+                epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fds[idx], nullptr);
+                num_pending--;
+            }
+            // Accumulate errors across iterations
+            if (error_code == error_code::NONE) {
+                error_code = ec;
+            }
+        }
         timer = duration_cast<milliseconds>(
             deadline - clock::now()).count();
     }
+    close(epoll_fd);
     if ((error_code == error_code::NONE) && (num_pending != 0)) {
         return error_code::SEND_REQS_TIMEOUT;
     }
@@ -198,58 +401,70 @@ error_code orchestrator::foreach_fragment_recv_generic(
 
     auto error_code = error_code::NONE;
     const size_t num_fds = fds.size();
+    if (num_fds == 0) { return error_code; }
 
     // Pending responses
     size_t num_pending = num_fds;
-    std::unique_ptr<pollfd[]> pfds = (
-        std::make_unique<pollfd[]>(num_fds));
+    std::vector<ctrl_transfer> xfers(num_fds);
+    std::vector<epoll_event> events(num_fds);
 
-    // Initialize pollfd array
+    int epoll_fd = epoll_create1(0);
+    if (epoll_fd < 0) { return error_code::POLL_ERROR; }
     for (size_t idx = 0; idx < num_fds; idx++) {
-        pfds[idx].events = POLLIN;
-        pfds[idx].fd = fds[idx];
-        pfds[idx].revents = 0;
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u32 = static_cast<uint32_t>(idx);
+        if (fds[idx] < 0) {
+            // Not connected, nothing to wait for
+            if (error_code == error_code::NONE) {
+                error_code = connection_error;
+            }
+            num_pending--;
+        }
+        else if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fds[idx], &event) < 0) {
+            close(epoll_fd); return error_code::POLL_ERROR;
+        }
     }
-
     auto start = clock::now();
     int64_t timer = timeout_communication_ms_;
     auto deadline = start + milliseconds(timer);
 
     while ((num_pending != 0) && (timer > 0)) {
-        int rc = poll(pfds.get(), num_fds, timer);
-        if (rc == 0) { break; } // Timeout
-        else if (rc > 0) {
-            assert(static_cast<size_t>(rc) <= num_pending);
-            for (size_t idx = 0; idx < num_fds; idx++) {
-                if ((pfds[idx].revents == POLLIN) &&
-                    (pfds[idx].fd > 0)) {
-
-                    auto current_ec = recv_with_timeout(
-                        fds[idx], msg_ctrl_, timer, connection_error);
-
-                    // Recv'd message correctly, check header
-                    if (current_ec == error_code::NONE) {
-                        current_ec = check_header(msg_ctrl_,
-                            check_fragment_ids, idx, type);
-                    }
-                    // Header check succeeded, process payload
-                    if (current_ec == error_code::NONE) {
-                        current_ec = lambda(idx, msg_ctrl_);
-                    }
-                    // Accumulate errors across iterations
-                    if (error_code == error_code::NONE) {
-                        error_code = current_ec;
-                    }
-                    // Disable polling for this FD
-                    pfds[idx].events = 0;
-                    pfds[idx].fd = -1;
-                    num_pending--;
-                }
+        int rc = epoll_wait(epoll_fd, events.data(),
+                            events.size(), timer);
+        for (int i = 0; i < rc; i++) {
+            const uint32_t idx = events[i].data.u32;
+            auto current_ec = try_recv(fds[idx], xfers[idx],
+                                       connection_error);
+
+            // Partial message, wait for the rest
+            if ((current_ec == error_code::NONE) && !xfers[idx].done) {
+                continue;
+            }
+            // Recv'd message correctly, check header
+            if (current_ec == error_code::NONE) {
+                memcpy(msg_ctrl_.buffer(), xfers[idx].buffer.data(),
+                       xfers[idx].buffer.size());
+
+                current_ec = check_header(msg_ctrl_,
+                    check_fragment_ids, idx, type);
             }
+            // Header check succeeded, process payload
+            if (current_ec == error_code::NONE) {
+                current_ec = lambda(idx, msg_ctrl_);
+            }
+            // Accumulate errors across iterations
+            if (error_code == error_code::NONE) {
+                error_code = current_ec;
+            }
+            // Stop polling this FD
+            epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fds[idx], nullptr);
+            num_pending--;
         }
         timer = duration_cast<milliseconds>(
             deadline - clock::now()).count();
     }
+    close(epoll_fd);
     if ((error_code == error_code::NONE) && (num_pending != 0)) {
         return error_code::RECV_WAIT_TIMEOUT;
     }
@@ -262,11 +477,6 @@ error_code orchestrator::foreach_fragment_recv_generic(
 error_code orchestrator::run_state_init() {
     assert(state_ == state_t::INIT);
     assert(fragments_.empty()); // Sanity checks
-
-    if (!autotest_mode_) { // Info
-        std::cout << "[Orchestrator] Started listening on port "
-                  << PORT_LISTEN_CTRL << std::endl;
-    }
     return error_code::NONE;
 }
 
@@ -280,13 +490,20 @@ error_code orchestrator::run_state_setup_ctrl() {
     // Ctrl server address
     sockaddr_in ctrl_netaddr{};
     ctrl_netaddr.sin_family = AF_INET;
-    ctrl_netaddr.sin_port = htons(PORT_LISTEN_CTRL);
+    ctrl_netaddr.sin_port = htons(ctrl_port_);
     ctrl_netaddr.sin_addr.s_addr = htonl(INADDR_ANY);
 
-    // Setup the ctrl server
+    // Setup the ctrl server. If auto-allocating, this updates
+    // the address with the port the kernel actually picked.
     DIE_ON_ERROR(server_setup(&listen_fd_ctrl_,
                  &ctrl_netaddr, num_nodes, true));
 
+    listen_port_ctrl_ = ntohs(ctrl_netaddr.sin_port);
+    if (!autotest_mode_) { // Info
+        std::cout << "[Orchestrator] Started listening on port "
+                  << listen_port_ctrl_ << std::endl;
+    }
+
     // Spawn thread to accept new connections
     accept_args args(listen_fd_ctrl_, true,
             timeout_connect_ms_, num_nodes);
@@ -295,41 +512,22 @@ error_code orchestrator::run_state_setup_ctrl() {
                               std::ref(args));
     while (!args.started) {}
 
-    bool success = true;
     if (autotest_mode_) {
-        // In autotest mode, fork and exec the fragment processes
-        for (size_t idx = 0; (idx < num_nodes) && success; idx++) {
-            pid_t pid = fork(); // Clone the current process
-            if (pid < 0) {
-                success = false;
-            }
-            else if (pid == 0) {
-                // Child process
-                auto listen_port = std::to_string(PORT_LISTEN_CTRL);
-                auto node_path = fragment_dir_ + "/node";
-                char *const argv_list[] = {
-                    const_cast<char*>(node_path.c_str()),   // 0: Executable path
-                    const_cast<char*>("127.0.0.1"),         // 1: Loopback IP
-                    const_cast<char*>(listen_port.c_str()), // 2: Server port
-                    NULL
-                };
-
-                execv(node_path.c_str(), argv_list);
-                exit(EXIT_FAILURE);
-            }
-            else {
-                // Parent process
-                fragments_.push_back(fragment_metadata());
-                fragments_[idx].pid = pid;
-            }
+        // In autotest mode, launch the fragment processes
+        error_code = (use_zygote_ ? spawn_fragments_zygote(num_nodes) :
+                                    spawn_fragments(num_nodes));
+
+        // Don't wait for fragments that will never connect
+        if (error_code != error_code::NONE) {
+            args.keep_running = false;
         }
     }
     else { fragments_.resize(num_nodes); }
     accept_thread.join();
 
     // Exit on error
-    if (!success) {
-        return error_code::FORK_FAILED;
+    if (error_code != error_code::NONE) {
+        return error_code;
     }
     else if (args.rc != 0) {
         return error_code::SOCKET_ACCEPT_FAILED;
@@ -388,6 +586,9 @@ error_code orchestrator::run_state_setup_ctrl() {
     auto send_lambda = [this] (const uint16_t, message& m) {
         auto payload = m.payload<message::request::setup_ctrl>();
         payload->autotest_mode = autotest_mode_;
+        payload->link_backend = link_backend_;
+        payload->link_transport = link_transport_;
+        payload->num_io_threads = num_io_threads_;
     };
     // Complete handshake
     return foreach_fragment_send_ctrl(
@@ -412,7 +613,7 @@ error_code orchestrator::run_state_setup_pcap() {
     // Pcap server address
     sockaddr_in pcap_netaddr{};
     pcap_netaddr.sin_family = AF_INET;
-    pcap_netaddr.sin_port = htons(PORT_LISTEN_PCAP);
+    pcap_netaddr.sin_port = htons(pcap_port_);
     pcap_netaddr.sin_addr.s_addr = htonl(INADDR_ANY);
 
     // Setup the pcap socket
@@ -494,6 +695,16 @@ orchestrator::run_state_create_topology() {
     auto error_code = error_code::NONE; // Return value
     const auto& topology = testcase_->get_graph().topology();
 
+    // Index the adjacency lists for link state changes
+    disabled_links_.clear();
+    last_link_change_ns_ = 0;
+    neighbor_ids_.clear();
+    for (uint16_t idx = 0; idx < topology.size(); idx++) {
+        for (uint16_t nid = 0; nid < topology[idx].size(); nid++) {
+            neighbor_ids_.emplace(((static_cast<uint32_t>(idx) << 16) |
+                                   topology[idx][nid]), nid);
+        }
+    }
     auto send_lambda = [this, topology] (const uint16_t idx, message& msg) {
         auto payload = msg.payload<message::request::topology>();
         const auto& node = testcase_->get_graph().get_node(idx);
@@ -508,6 +719,11 @@ orchestrator::run_state_create_topology() {
         payload->reelection_interval_ms = testcase_->reelection_interval_ms();
         payload->root_hello_interval_ms = testcase_->root_hello_interval_ms();
 
+        // Capture configuration
+        payload->pcap_queue_depth = testcase_->pcap_queue_depth();
+        payload->pcap_block_timeout_ms = testcase_->pcap_block_timeout_ms();
+        payload->pcap_overflow_policy = testcase_->pcap_overflow();
+
         for (uint16_t nid = 0; nid < topology[idx].size(); nid++) {
             payload->link_costs()[nid] = node.link_costs()[nid];
         }
@@ -556,8 +772,12 @@ orchestrator::run_state_start_mixnet_server() {
         fragments_[idx].mixnet_server_netaddr = (
             payload->server_netaddr);
 
-        fragments_[idx].mixnet_server_netaddr.
-            sin_addr.s_addr = baseaddr.sin_addr.s_addr;
+        // Local servers are identified by the fragment's PID,
+        // so only TCP servers are remapped to the peer's IP.
+        if (link_transport_ == networking::transport::TCP) {
+            fragments_[idx].mixnet_server_netaddr.
+                sin_addr.s_addr = baseaddr.sin_addr.s_addr;
+        }
 
         return error_code::NONE;
     };
@@ -682,10 +902,32 @@ orchestrator::run_state_end_testcase() {
         message::type::END_TESTCASE, [this] (
                 const uint16_t, message&) {}));
 
-    // Wait for acknowledgement
+    // Wait for acknowledgement, collecting capture statistics
     return foreach_fragment_recv_ctrl(
         message::type::END_TESTCASE, [this] (
-            const uint16_t, const message&) {
+            const uint16_t idx, const message& m) {
+                const auto payload = m.payload<
+                    message::response::end_testcase>();
+
+                if (payload->pcap_drops != 0) {
+                    std::cout << "[Orchestrator] Fragment " << idx << " dropped "
+                              << payload->pcap_drops << " captured packet(s)"
+                              << std::endl;
+                }
+                testcase_->pcap_drops(idx, payload->pcap_drops);
+
+                traffic_stats stats;
+                stats.num_sent = payload->traffic_sent;
+                stats.num_drops = payload->traffic_drops;
+                stats.duration_ns = payload->traffic_duration_ns;
+                if ((stats.num_sent != 0) || (stats.num_drops != 0)) {
+                    std::cout << "[Orchestrator] Fragment " << idx << " generated "
+                              << stats.num_sent << " packet(s) at "
+                              << static_cast<uint64_t>(stats.rate_pps())
+                              << " pps (" << stats.num_drops << " dropped)"
+                              << std::endl;
+                }
+                testcase_->traffic_report(idx, stats);
                 return error_code::NONE; });
 }
 
@@ -705,6 +947,43 @@ orchestrator::run_state_graceful_shutdown() {
         message::type::SHUTDOWN, lambda);
 }
 
+error_code
+orchestrator::run_state_reset_fragments() {
+    assert(state_ == state_t::RESET_FRAGMENTS);
+    auto error_code = error_code::NONE; // Return value
+    const uint16_t num_nodes = testcase_->get_graph().num_nodes;
+    assert(fragments_.size() >= num_nodes); // Sanity check
+
+    // Shut down the fragments that this testcase doesn't use
+    while (fragments_.size() > num_nodes) {
+        const uint16_t fid = (fragments_.size() - 1);
+        DIE_ON_ERROR(fragment_request_response(fid,
+            message::type::SHUTDOWN, [] (message&) {}));
+
+        close(fragments_[fid].fd_ctrl);
+        close(fragments_[fid].fd_pcap);
+        fragments_.pop_back();
+    }
+    // Wipe the previous testcase's state
+    pcap_thread_error_ = error_code::NONE;
+    pcap_thread_run_ = true;
+    latency_.clear();
+
+    for (auto& fragment : fragments_) {
+        fragment.is_pcap_subscribed = false;
+        fragment.mixnet_server_netaddr = sockaddr_in{};
+        fragment.mixnet_client_netaddrs.clear();
+    }
+    // Send the message to every fragment
+    DIE_ON_ERROR(foreach_fragment_send_ctrl(
+        message::type::RESET, [this] (const uint16_t, message&) {}));
+
+    // Wait for acknowledgement
+    return foreach_fragment_recv_ctrl(
+        message::type::RESET, [this] (const uint16_t, const message&) {
+                                        return error_code::NONE; });
+}
+
 /**
  * FSM functionality: ORCHESTRATOR methods.
  */
@@ -725,79 +1004,148 @@ void orchestrator::run_state_reset() {
 
     pcap_thread_error_ = error_code::NONE;
     pcap_thread_run_ = true;
+    latency_.clear();
 
     listen_fd_ctrl_ = -1;
     listen_fd_pcap_ = -1;
+    listen_port_ctrl_ = 0;
     fragments_.clear();
 }
 
 /**
  * Pcap loop.
  */
-void orchestrator::pcap_thread_loop() {
-    using namespace networking;
-    auto error_code = error_code::NONE;
+error_code orchestrator::start_pcap_threads() {
     const size_t num_fragments = fragments_.size();
-    auto packet = msg_pcap_.payload<mixnet_packet>();
+    num_pcap_workers_ = static_cast<uint16_t>(std::min<size_t>(
+        std::min(num_pcap_threads_, MAX_NUM_PCAP_THREADS), num_fragments));
 
-    std::unique_ptr<pollfd[]> pfds = (
-        std::make_unique<pollfd[]>(num_fragments));
+    if (num_pcap_workers_ == 0) { return error_code::NONE; }
+    pcap_workers_ = std::make_unique<pcap_worker[]>(num_pcap_workers_);
 
+    for (uint16_t wid = 0; wid < num_pcap_workers_; wid++) {
+        pcap_workers_[wid].epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if (pcap_workers_[wid].epoll_fd < 0) { return error_code::POLL_ERROR; }
+    }
+    // Shard the fragments' pcap FDs across the workers
     for (size_t fid = 0; fid < num_fragments; fid++) {
-        pfds[fid].fd = fragments_[fid].fd_pcap;
-        pfds[fid].events = POLLIN;
-        pfds[fid].revents = 0;
+        epoll_event event{};
+        event.events = (EPOLLIN | EPOLLET);
+        event.data.u32 = static_cast<uint32_t>(fid);
+
+        const int epoll_fd = pcap_workers_[fid % num_pcap_workers_].epoll_fd;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD,
+                      fragments_[fid].fd_pcap, &event) < 0) {
+            return error_code::POLL_ERROR;
+        }
     }
+    for (uint16_t wid = 0; wid < num_pcap_workers_; wid++) {
+        pcap_workers_[wid].thread = std::thread(
+            &orchestrator::pcap_thread_loop, this,
+            std::ref(pcap_workers_[wid]));
+    }
+    return error_code::NONE;
+}
 
-    while (pcap_thread_run_ && (error_code == error_code::NONE)) {
-        int rc = poll(pfds.get(), num_fragments, PCAP_POLL_TIMEOUT_MS);
-        if (rc < 0) { error_code = error_code::POLL_ERROR; }
+void orchestrator::stop_pcap_threads() {
+    pcap_thread_run_ = false;
+    for (uint16_t wid = 0; wid < num_pcap_workers_; wid++) {
+        pcap_worker& worker = pcap_workers_[wid];
+        if (worker.thread.joinable()) { worker.thread.join(); }
+        if (worker.epoll_fd != -1) { close(worker.epoll_fd); }
+    }
+    pcap_workers_.reset();
+    num_pcap_workers_ = 0;
+}
 
-        for (size_t fid = 0; fid < num_fragments; fid++) {
-            const bool is_subscribed = (
-                fragments_[fid].is_pcap_subscribed);
-
-            // Set up for next poll iteration
-            pfds[fid].fd = (is_subscribed ?
-                fragments_[fid].fd_pcap : -1);
-
-            // Ignore any unsubscribed fragments
-            if ((pfds[fid].revents != POLLIN) ||
-                !is_subscribed) { continue; }
-
-            // Attempt to receive a message (with small timeout)
-            error_code = recv_with_timeout(fragments_[fid].fd_pcap,
-                                           msg_pcap_, PCAP_POLL_TIMEOUT_MS,
-                                           error_code::PCAP_CONNECTION_BROKEN);
-            // Received a message
-            if (error_code == error_code::NONE) {
-                // Validate the message header
-                error_code = check_header(msg_pcap_, true, fid,
-                                          message::type::PCAP_DATA);
-
-                if (error_code != error_code::NONE) { break; }
-                if (packet->total_size > MAX_MIXNET_PACKET_SIZE) {
-                    // We perform several layers of filtering for malformed
-                    // packets before this, so really shouldn't reach here.
-                    error_code = error_code::MIXNET_BAD_PACKET_SIZE;
-                    break;
-                }
-                // Valid packet, invoke callback
-                testcase_->pcap(msg_pcap_.get_fragment_id(),
-                                msg_pcap_.payload<mixnet_packet>());
+error_code orchestrator::pcap_recv_batch(const uint16_t fid, message& msg,
+                                         const bool dispatch) {
+    using namespace networking;
+    typedef message::response::pcap_data::record record_t;
+    auto payload = msg.payload<message::response::pcap_data>();
+
+    // Only consume whole messages (the FD is edge-triggered, so
+    // the remainder of a partial message triggers another event).
+    config c{mode::RX_TRY_ONCE, 0};
+    auto error_code = recv_generic<message::length_t>(
+        c, fragments_[fid].fd_pcap, msg.buffer(),
+        error_code::PCAP_CONNECTION_BROKEN,
+        message::MIN_MESSAGE_LENGTH, message::MAX_MESSAGE_LENGTH);
+
+    if (error_code != error_code::NONE) { return error_code; }
+
+    // Validate the message header
+    DIE_ON_ERROR(check_header(msg, true, fid,
+                              message::type::PCAP_DATA));
+
+    // Discard batches that arrive while unsubscribed
+    if (!dispatch) { return error_code::NONE; }
+
+    // Invoke the callback for each packet in the batch
+    auto record = payload->records();
+    size_t offset = 0;
+    for (uint16_t i = 0; i < payload->num_records; i++) {
+        // Packets may have been truncated by the pcap filter,
+        // in which case only the packet type can be checked.
+        const size_t size = record_t::size(record->caplen);
+        const auto packet = record->packet();
+        if (((offset + size) > payload->records_length) ||
+            (record->caplen < MIN_MIXNET_PACKET_SIZE) ||
+            (record->caplen > packet->total_size) ||
+            !((record->caplen == packet->total_size) ?
+              validation::validate_user(packet) :
+              validation::lookup(packet->type).is_user_type)) {
+            // We perform several layers of filtering for malformed
+            // packets before this, so really shouldn't reach here.
+            return error_code::MIXNET_BAD_PACKET_SIZE;
+        }
+        // Valid packet, invoke the callback (only complete packets
+        // may be walked past the header, so truncated ones have their
+        // own callback, which also receives the capture length).
+        if (record->caplen == packet->total_size) {
+            if (track_latency_) {
+                latency_.on_deliver(packet, record->timestamp_ns);
             }
-            // Received zero messages, clear error. TODO(natre): This
-            // should not really happen because of the preceding poll
-            // call, so consider treating this as a real error.
-            else if (error_code == error_code::RECV_ZERO_PENDING) {
+            testcase_->pcap(fid, packet);
+        }
+        else { testcase_->pcap_truncated(fid, packet, record->caplen); }
+        offset += size;
+        record = record->next();
+    }
+    return error_code::NONE;
+}
+
+void orchestrator::pcap_thread_loop(pcap_worker& worker) {
+    static constexpr int MAX_EVENTS = 64;
+    epoll_event events[MAX_EVENTS];
+    auto error_code = error_code::NONE;
+
+    while (pcap_thread_run_ && (error_code == error_code::NONE)) {
+        int rc = epoll_wait(worker.epoll_fd, events,
+                            MAX_EVENTS, PCAP_POLL_TIMEOUT_MS);
+        if (rc < 0) {
+            if (errno != EINTR) { error_code = error_code::POLL_ERROR; }
+            continue;
+        }
+        for (int i = 0; (i < rc) && (error_code == error_code::NONE); i++) {
+            const auto fid = static_cast<uint16_t>(events[i].data.u32);
+
+            // Drain every complete message on this FD, even if the
+            // fragment is unsubscribed (the FD is edge-triggered, so
+            // stale batches would otherwise linger until the next
+            // edge, then surface amid later subscriptions' packets).
+            const bool dispatch = fragments_[fid].is_pcap_subscribed;
+            do { error_code = pcap_recv_batch(fid, worker.msg, dispatch); }
+            while (error_code == error_code::NONE);
+
+            if (error_code == error_code::RECV_ZERO_PENDING) {
                 error_code = error_code::NONE;
             }
-            // Irrecoverable error
-            else { break; }
         }
-        // Update the thread's error status
-        pcap_thread_error_ = error_code;
     }
+    // Update the error status (the first error sticks)
+    auto expected = error_code::NONE;
+    pcap_thread_error_.compare_exchange_strong(expected, error_code);
 }
 
 /**
@@ -816,6 +1164,13 @@ error_code orchestrator::run(testing::testcase& testcase) {
 
     // Run testcase setup
     testcase_->setup();
+    const auto setup_start = clock::now();
+
+    // Reuse the fragments from the previous run, if there are enough
+    if (fragments_.size() < testcase_->get_graph().num_nodes) {
+        release_fragments();
+    }
+    if (!fragments_.empty()) { state_ = state_t::RESET_FRAGMENTS; }
 
     while (!done) {
         auto error_code = error_code::NONE;
@@ -882,16 +1237,26 @@ error_code orchestrator::run(testing::testcase& testcase) {
             next_state = (error_code == error_code::NONE) ?
                           state_t::RUN_TESTCASE :
                           state_t::END_TESTCASE;
+
+            // Report the time taken to get here
+            setup_time_ms_ = duration_cast<milliseconds>(
+                clock::now() - setup_start).count();
+
+            if (error_code == error_code::NONE) {
+                std::cout << "[Orchestrator] Reached START_TESTCASE in "
+                          << setup_time_ms_ << " ms" << std::endl;
+            }
         } break;
 
         // Run test-case
         case state_t::RUN_TESTCASE: {
-            pcap_thread_ = std::thread(
-                &orchestrator::pcap_thread_loop, this);
+            error_code = start_pcap_threads();
+            if (error_code == error_code::NONE) {
+                error_code = testcase_->run(*this);
+            }
+            stop_pcap_threads();
 
-            error_code = testcase_->run(*this);
-            pcap_thread_run_ = false;
-            pcap_thread_.join();
+            if (track_latency_) { latency_.report(std::cout); }
 
             next_state = state_t::END_TESTCASE;
         } break;
@@ -900,6 +1265,10 @@ error_code orchestrator::run(testing::testcase& testcase) {
         case state_t::END_TESTCASE: {
             error_code = run_state_end_testcase();
             next_state = state_t::GRACEFUL_SHUTDOWN;
+
+            // Keep the fragments for the next run (unless anything failed)
+            if (reuse_fragments_ && (error_code == error_code::NONE) &&
+                (exit_code == error_code::NONE)) { done = true; }
         } break;
 
         // Perform graceful shutdown
@@ -924,6 +1293,14 @@ error_code orchestrator::run(testing::testcase& testcase) {
             error_code = error_code::NONE;
         } break;
 
+        // Reuse the previous run's fragments
+        case state_t::RESET_FRAGMENTS: {
+            error_code = run_state_reset_fragments();
+            next_state = (error_code == error_code::NONE) ?
+                          state_t::CREATE_MIXNET_TOPOLOGY :
+                          state_t::GRACEFUL_SHUTDOWN;
+        } break;
+
         // Unknown state
         default: { assert(false); }
         } // switch
@@ -953,11 +1330,35 @@ error_code orchestrator::run(testing::testcase& testcase) {
 /**
  * Public API.
  */
+void orchestrator::release_fragments() {
+    if (fragments_.empty()) { return; }
+
+    state_ = state_t::GRACEFUL_SHUTDOWN;
+    if (run_state_graceful_shutdown() != error_code::NONE) {
+        state_ = state_t::FORCEFUL_SHUTDOWN;
+        run_state_forceful_shutdown();
+    }
+    state_ = state_t::RESET;
+    run_state_reset();
+}
+
 void orchestrator::configure(const std::string& bin_dir,
-                             const bool autotest_mode) {
+                             const options& options) {
     // Update configuration
     fragment_dir_ = bin_dir;
-    autotest_mode_ = autotest_mode;
+    autotest_mode_ = options.autotest_mode;
+    ctrl_port_ = options.ctrl_port;
+    pcap_port_ = options.pcap_port;
+    link_backend_ = options.link_backend;
+    link_transport_ = options.link_transport;
+    num_io_threads_ = options.num_io_threads;
+    num_pcap_threads_ = options.num_pcap_threads;
+    track_latency_ = options.track_latency;
+    latency_.set_tag(options.latency_tag);
+    use_zygote_ = options.use_zygote;
+    reuse_fragments_ = options.reuse_fragments;
+    pcapng_dir_ = options.pcapng_dir;
+    pcapng_links_ = options.pcapng_links;
 
     // Use large timeouts in manual mode
     if (!autotest_mode_) {
@@ -968,56 +1369,79 @@ void orchestrator::configure(const std::string& bin_dir,
 }
 
 error_code orchestrator::pcap_change_subscription(
-    const uint16_t idx, const bool subscribe) {
+    const uint16_t idx, const bool subscribe,
+    const pcap_filter& filter) {
     assert(state_ == state_t::RUN_TESTCASE);
+    assert((filter.src_addrs.size() <= pcap_filter::MAX_NUM_ADDRS) &&
+           (filter.dst_addrs.size() <= pcap_filter::MAX_NUM_ADDRS));
 
     auto& current_subscription = (
         fragments_[idx].is_pcap_subscribed);
 
-    if (current_subscription == subscribe) {
+    if (!subscribe && !current_subscription) {
         // No change in subscription, return
         return error_code::NONE;
     }
     current_subscription = subscribe;
     // Lambda to populate the message payload
-    auto lambda = [this, subscribe] (message& m) {
+    auto lambda = [this, subscribe, &filter] (message& m) {
         auto payload = m.payload<message::
             request::pcap_subscription>();
 
         payload->subscribe = subscribe;
+        payload->type_mask = filter.type_mask;
+        payload->sample_rate = filter.sample_rate;
+        payload->snaplen = filter.snaplen;
+        payload->num_src_addrs = filter.src_addrs.size();
+        payload->num_dst_addrs = filter.dst_addrs.size();
+
+        mixnet_address *addrs = payload->addrs();
+        for (const mixnet_address addr : filter.src_addrs) { *addrs++ = addr; }
+        for (const mixnet_address addr : filter.dst_addrs) { *addrs++ = addr; }
     };
     return fragment_request_response(
         idx, message::type::PCAP_SUBSCRIPTION, lambda);
 }
 
-error_code orchestrator::change_link_state(const uint16_t idx_a,
-                                           const uint16_t idx_b,
-                                           const bool is_enabled) {
-    const auto& topology = testcase_->get_graph().topology();
-    assert(state_ == state_t::RUN_TESTCASE);
-    size_t b_nid_in_a = 0, a_nid_in_b = 0;
-    size_t num_success = 0;
-
-    assert((idx_a < topology.size()) && (idx_b < topology.size()));
-    for (size_t nid = 0; nid < topology[idx_a].size(); nid++) {
-        if (topology[idx_a][nid] == idx_b) {
-            b_nid_in_a = nid; num_success++;
-            break;
-        }
-    }
-    for (size_t nid = 0; nid < topology[idx_b].size(); nid++) {
-        if (topology[idx_b][nid] == idx_a) {
-            a_nid_in_b = nid; num_success++;
-            break;
-        }
-    }
-    if (num_success != 2) {
+error_code orchestrator::lookup_link(const uint16_t idx_a,
+                                     const uint16_t idx_b,
+                                     uint16_t& b_nid_in_a,
+                                     uint16_t& a_nid_in_b) const {
+    auto it_a = neighbor_ids_.find((static_cast<uint32_t>(idx_a) << 16) | idx_b);
+    auto it_b = neighbor_ids_.find((static_cast<uint32_t>(idx_b) << 16) | idx_a);
+
+    if ((it_a == neighbor_ids_.end()) || (it_b == neighbor_ids_.end())) {
         std::cout << "[Orchestrator] Improper adjacency relationship "
                   << "between nodes " << idx_a << " and " << idx_b
                   << ", please check topology" << std::endl;
 
         return error_code::BAD_TESTCASE;
     }
+    b_nid_in_a = it_a->second;
+    a_nid_in_b = it_b->second;
+    return error_code::NONE;
+}
+
+void orchestrator::record_link_state(const uint16_t idx_a,
+                                     const uint16_t idx_b,
+                                     const bool is_enabled) {
+    const uint32_t key = ((static_cast<uint32_t>(std::min(idx_a, idx_b)) << 16) |
+                          std::max(idx_a, idx_b));
+
+    if (is_enabled) { disabled_links_.erase(key); }
+    else { disabled_links_.insert(key); }
+    last_link_change_ns_ = monotonic_ns();
+}
+
+error_code orchestrator::change_link_state(const uint16_t idx_a,
+                                           const uint16_t idx_b,
+                                           const bool is_enabled) {
+    assert(state_ == state_t::RUN_TESTCASE);
+    auto error_code = error_code::NONE;
+    uint16_t b_nid_in_a = 0, a_nid_in_b = 0;
+    DIE_ON_ERROR(lookup_link(idx_a, idx_b, b_nid_in_a, a_nid_in_b));
+    record_link_state(idx_a, idx_b, is_enabled);
+
     // Lambdas to populate the payloads
     auto lambda_a = [this, b_nid_in_a, is_enabled] (message& m) {
         auto payload = m.payload<message::
@@ -1033,7 +1457,6 @@ error_code orchestrator::change_link_state(const uint16_t idx_a,
         payload->neighbor_id = a_nid_in_b;
         payload->state = is_enabled;
     };
-    auto error_code = error_code::NONE;
     DIE_ON_ERROR(fragment_request_response(idx_a,
         message::type::CHANGE_LINK_STATE, lambda_a));
 
@@ -1041,6 +1464,165 @@ error_code orchestrator::change_link_state(const uint16_t idx_a,
         message::type::CHANGE_LINK_STATE, lambda_b);
 }
 
+error_code orchestrator::change_link_states(
+    const std::vector<link_change>& changes) {
+    assert(state_ == state_t::RUN_TESTCASE);
+    auto error_code = error_code::NONE;
+
+    // Resolve the changes into (NID -> state) maps per fragment
+    std::vector<std::map<uint16_t, bool>> batches(fragments_.size());
+    for (const auto& change : changes) {
+        uint16_t b_nid_in_a = 0, a_nid_in_b = 0;
+        DIE_ON_ERROR(lookup_link(change.idx_a, change.idx_b,
+                                 b_nid_in_a, a_nid_in_b));
+
+        batches[change.idx_a][b_nid_in_a] = change.is_enabled;
+        batches[change.idx_b][a_nid_in_b] = change.is_enabled;
+    }
+    for (const auto& change : changes) {
+        record_link_state(change.idx_a, change.idx_b, change.is_enabled);
+    }
+    // Send every fragment its batch (possibly empty), then wait
+    DIE_ON_ERROR(foreach_fragment_send_ctrl(
+        message::type::CHANGE_LINK_STATE_BATCH,
+        [&batches] (const uint16_t idx, message& m) {
+        auto payload = m.payload<message::request::change_link_state_batch>();
+        auto record = payload->changes();
+
+        for (const auto& [nid, state] : batches[idx]) {
+            record->neighbor_id = nid;
+            record->state = state;
+            record++;
+        }
+        payload->num_changes = batches[idx].size();
+    }));
+    return foreach_fragment_recv_ctrl(
+        message::type::CHANGE_LINK_STATE_BATCH, []
+        (const uint16_t, const message&) { return error_code::NONE; });
+}
+
+error_code
+orchestrator::query_node_states(std::vector<node_state>& states) {
+    assert(state_ == state_t::RUN_TESTCASE);
+    auto error_code = error_code::NONE;
+    states.assign(fragments_.size(), node_state());
+
+    DIE_ON_ERROR(foreach_fragment_send_ctrl(
+        message::type::CONVERGENCE_STATUS,
+        [] (const uint16_t, message&) {}));
+
+    return foreach_fragment_recv_ctrl(message::type::CONVERGENCE_STATUS,
+        [&states] (const uint16_t idx, const message& m) {
+        auto payload = m.payload<message::response::convergence_status>();
+        auto& state = states[idx];
+
+        state.has_reported = payload->has_reported;
+        state.root_address = payload->root_address;
+        state.path_length = payload->path_length;
+        state.next_hop = payload->next_hop;
+        state.lsdb_size = payload->lsdb_size;
+        state.stable_ms = (payload->stable_ns / 1000000);
+        state.last_change_us = (payload->last_change_ns / 1000);
+        state.stp_packets_sent = payload->stp_packets_sent;
+        state.lsa_packets_sent = payload->lsa_packets_sent;
+        state.spf_runs = payload->spf_runs;
+        return error_code::NONE;
+    });
+}
+
+bool orchestrator::is_converged(
+    const std::vector<node_state>& states) const {
+    const auto& graph = testcase_->get_graph();
+    const auto& topology = graph.topology();
+    const uint16_t num_nodes = graph.num_nodes;
+    if (states.size() != num_nodes) { return false; }
+
+    // Wait out the quiet period (and the reelection timer)
+    const uint64_t quiet_ms = (CONVERGENCE_QUIET_HELLOS *
+                               testcase_->root_hello_interval_ms());
+    const uint64_t link_change_ms = ((monotonic_ns() -
+                                      last_link_change_ns_) / 1000000);
+    if ((last_link_change_ns_ != 0) && (link_change_ms <
+        (testcase_->reelection_interval_ms() + quiet_ms))) {
+        return false;
+    }
+    std::unordered_map<mixnet_address, uint16_t> idxs;
+    for (uint16_t idx = 0; idx < num_nodes; idx++) {
+        if (!states[idx].has_reported ||
+            (states[idx].stable_ms < quiet_ms)) { return false; }
+
+        idxs[graph.get_node(idx).mixaddr()] = idx;
+    }
+    auto is_enabled = [this] (const uint16_t a, const uint16_t b) {
+        return (disabled_links_.count(
+            (static_cast<uint32_t>(std::min(a, b)) << 16) |
+            std::max(a, b)) == 0);
+    };
+    // Explore every component by BFS from its (purported) root
+    std::vector<int> distances(num_nodes, -1);
+    for (uint16_t idx = 0; idx < num_nodes; idx++) {
+        if (distances[idx] != -1) { continue; }
+
+        const mixnet_address root_mixaddr = states[idx].root_address;
+        auto root = idxs.find(root_mixaddr);
+        if ((root == idxs.end()) || (distances[root->second] != -1)) {
+            return false;
+        }
+        std::vector<uint16_t> members{root->second};
+        distances[root->second] = 0;
+        for (size_t i = 0; i < members.size(); i++) {
+            const uint16_t member = members[i];
+            for (const uint16_t neighbor : topology[member]) {
+                if ((distances[neighbor] == -1) &&
+                    is_enabled(member, neighbor)) {
+                    distances[neighbor] = (distances[member] + 1);
+                    members.push_back(neighbor);
+                }
+            }
+        }
+        // The root doesn't belong to this node's component
+        if (distances[idx] == -1) { return false; }
+
+        for (const uint16_t member : members) {
+            const auto& state = states[member];
+            if ((state.root_address != root_mixaddr) ||
+                (state.path_length != distances[member]) ||
+                (state.lsdb_size < members.size())) {
+                return false;
+            }
+            // The next hop must be one hop closer to the root
+            if (member == root->second) { continue; }
+            auto next_hop = idxs.find(state.next_hop);
+            if ((next_hop == idxs.end()) ||
+                (distances[next_hop->second] != (distances[member] - 1)) ||
+                (neighbor_ids_.count((static_cast<uint32_t>(member) << 16) |
+                                     next_hop->second) == 0) ||
+                !is_enabled(member, next_hop->second)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool orchestrator::await_convergence(const uint32_t timeout_ms) {
+    assert(state_ == state_t::RUN_TESTCASE);
+    const auto poll_interval = milliseconds(std::max<uint32_t>(
+        1, (testcase_->root_hello_interval_ms() / 2)));
+
+    const auto deadline = clock::now() + milliseconds(timeout_ms);
+    std::vector<node_state> states;
+    while (true) {
+        if ((query_node_states(states) == error_code::NONE) &&
+            is_converged(states)) { return true; }
+
+        const auto now = clock::now();
+        if (now >= deadline) { return false; }
+        std::this_thread::sleep_for(std::min<clock::duration>(
+            poll_interval, (deadline - now)));
+    }
+}
+
 error_code
 orchestrator::send_packet(const uint16_t src_idx,
                           const uint16_t dst_idx,
@@ -1073,13 +1655,182 @@ orchestrator::send_packet(const uint16_t src_idx,
 
         payload->data_length = data_string.size();
     };
-    return fragment_request_response(
+    auto error_code = fragment_request_response(
         src_idx, message::type::SEND_PACKET, lambda);
+
+    // Record the injection time reported by the fragment
+    if (track_latency_ && (error_code == error_code::NONE)) {
+        const auto& graph = testcase_->get_graph();
+        latency_.on_inject(graph.get_node(src_idx).mixaddr(),
+                           graph.get_node(dst_idx).mixaddr(), type,
+                           data_string.data(), data_string.size(),
+                           msg_ctrl_.payload<message::response::
+                                             send_packet>()->timestamp_ns);
+    }
+    return error_code;
+}
+
+error_code
+orchestrator::send_packets(const std::vector<packet_spec>& packets) {
+    assert(state_ == state_t::RUN_TESTCASE);
+    auto error_code = error_code::NONE; // Return value
+    const auto& graph = testcase_->get_graph();
+    const size_t num_fragments = fragments_.size();
+
+    // Group packets by source, preserving their order
+    std::vector<std::vector<const packet_spec*>> queues(num_fragments);
+    for (const auto& packet : packets) {
+        if (packet.data.size() > MAX_MIXNET_DATA_SIZE) {
+            std::cout << "[Orchestrator] Payload data should be "
+                      << "smaller than " << MAX_MIXNET_DATA_SIZE
+                      << " bytes" << std::endl;
+
+            return error_code::BAD_TESTCASE;
+        }
+        else if ((packet.src_idx >= num_fragments) ||
+                 (packet.dst_idx >= num_fragments)) {
+            return error_code::BAD_TESTCASE;
+        }
+        queues[packet.src_idx].push_back(&packet);
+    }
+    // Space available for packet records in a single message
+    constexpr size_t max_packets_length = (
+        message::MAX_MESSAGE_LENGTH - message::MIN_MESSAGE_LENGTH -
+        sizeof(message::request::send_packet_batch));
+
+    // Every round carries the next batch for each fragment
+    std::vector<size_t> cursors(num_fragments, 0);
+    std::vector<uint16_t> batch_sizes(num_fragments, 0);
+    auto is_pending = [&] () {
+        for (size_t fid = 0; fid < num_fragments; fid++) {
+            if (cursors[fid] < queues[fid].size()) { return true; }
+        }
+        return false;
+    };
+    auto send_lambda = [&] (const uint16_t idx, message& m) {
+        auto payload = m.payload<message::request::send_packet_batch>();
+        auto record = payload->packets();
+        const auto& queue = queues[idx];
+        size_t length = 0;
+        uint16_t count = 0;
+
+        for (size_t i = cursors[idx]; i < queue.size(); i++) {
+            const packet_spec& packet = *queue[i];
+            const size_t size = message::request::send_packet::size(
+                                                packet.data.size());
+            if ((length + size) > max_packets_length) { break; }
+
+            record->type = packet.type;
+            record->src_mixaddr = graph.get_node(packet.src_idx).mixaddr();
+            record->dst_mixaddr = graph.get_node(packet.dst_idx).mixaddr();
+            record->data_length = packet.data.size();
+            memcpy(record->data(), packet.data.data(), packet.data.size());
+
+            record = record->next();
+            length += size; count++;
+        }
+        payload->num_packets = count;
+        payload->packets_length = length;
+        batch_sizes[idx] = count;
+    };
+    auto recv_lambda = [&] (const uint16_t idx, const message& m) {
+        auto payload = m.payload<message::response::send_packet_batch>();
+        if (payload->num_packets != batch_sizes[idx]) {
+            return error_code::FRAGMENT_EXCEPTION;
+        }
+        // Record the injection times reported by the fragment
+        for (uint16_t i = 0; track_latency_ && (i < batch_sizes[idx]); i++) {
+            const packet_spec& packet = *queues[idx][cursors[idx] + i];
+            latency_.on_inject(graph.get_node(packet.src_idx).mixaddr(),
+                               graph.get_node(packet.dst_idx).mixaddr(),
+                               packet.type, packet.data.data(),
+                               packet.data.size(),
+                               payload->timestamps_ns()[i]);
+        }
+        cursors[idx] += batch_sizes[idx];
+        return error_code::NONE;
+    };
+    while (is_pending()) {
+        DIE_ON_ERROR(foreach_fragment_send_ctrl(
+            message::type::SEND_PACKET_BATCH, send_lambda));
+
+        DIE_ON_ERROR(foreach_fragment_recv_ctrl(
+            message::type::SEND_PACKET_BATCH, recv_lambda));
+    }
+    return error_code;
+}
+
+error_code
+orchestrator::start_traffic(const uint16_t idx,
+                            const traffic_profile& profile) {
+    assert(state_ == state_t::RUN_TESTCASE);
+    const auto& graph = testcase_->get_graph();
+    const uint16_t num_nodes = graph.num_nodes;
+
+    // Default to every other node, with equal weights
+    auto dsts = profile.dsts;
+    if (dsts.empty()) {
+        for (uint16_t dst_idx = 0; dst_idx < num_nodes; dst_idx++) {
+            if (dst_idx != idx) { dsts.emplace_back(dst_idx, 1); }
+        }
+    }
+    if ((idx >= num_nodes) || dsts.empty() ||
+        (dsts.size() > traffic_profile::MAX_NUM_DSTS) ||
+        (profile.min_data_length > profile.max_data_length) ||
+        (profile.max_data_length > MAX_MIXNET_DATA_SIZE)) {
+        return error_code::BAD_TESTCASE;
+    }
+    for (const auto& [dst_idx, weight] : dsts) {
+        if (dst_idx >= num_nodes) { return error_code::BAD_TESTCASE; }
+    }
+    return fragment_request_response(idx, message::type::TRAFFIC_PROFILE,
+        [&profile, &dsts, &graph] (message& m) {
+        auto payload = m.payload<message::request::traffic_profile>();
+        payload->type = profile.type;
+        payload->arrival = profile.arrival;
+        payload->rate_pps = profile.rate_pps;
+        payload->duration_ms = profile.duration_ms;
+        payload->seed = profile.seed;
+        payload->min_data_length = profile.min_data_length;
+        payload->max_data_length = profile.max_data_length;
+        payload->num_dsts = dsts.size();
+
+        for (size_t i = 0; i < dsts.size(); i++) {
+            payload->dsts()[i].mixaddr = graph.get_node(
+                                dsts[i].first).mixaddr();
+            payload->dsts()[i].weight = dsts[i].second;
+        }
+    });
+}
+
+error_code
+orchestrator::start_traffic(const traffic_profile& profile,
+    const std::vector<std::vector<uint32_t>>& matrix) {
+    auto error_code = error_code::NONE;
+    if (matrix.size() > testcase_->get_graph().num_nodes) {
+        return error_code::BAD_TESTCASE;
+    }
+    for (uint16_t src_idx = 0; src_idx < matrix.size(); src_idx++) {
+        traffic_profile row = profile;
+        row.rate_pps = 0; row.dsts.clear();
+
+        // Each row is a weighted destination set
+        for (uint16_t dst_idx = 0; dst_idx < matrix[src_idx].size(); dst_idx++) {
+            if (matrix[src_idx][dst_idx] == 0) { continue; }
+            row.rate_pps += matrix[src_idx][dst_idx];
+            row.dsts.emplace_back(dst_idx, matrix[src_idx][dst_idx]);
+        }
+        if (row.dsts.empty()) { continue; } // Nothing to send
+        DIE_ON_ERROR(start_traffic(src_idx, row));
+    }
+    return error_code;
 }
 
 /**
  * Constructor.
  */
+orchestrator::~orchestrator() { release_fragments(); }
+
 orchestrator::orchestrator() {
     // Register signal handler
     signal(SIGPIPE, SIG_IGN);
@@ -12,12 +12,19 @@
 #define FRAMEWORK_ORCHESTRATOR_H_
 
 #include "error.h"
+#include "latency.h"
 #include "message.h"
+#include "pcap_filter.h"
+#include "traffic_profile.h"
 #include "mixnet/address.h"
 
+#include <atomic>
 #include <functional>
+#include <memory>
 #include <string>
 #include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 // Forward declaration
@@ -35,14 +42,18 @@ namespace framework {
  */
 class orchestrator final {
 public:
-    // Orchestrator's ctrl port number
+    // Orchestrator's default ctrl port number
     static constexpr uint16_t PORT_LISTEN_CTRL = 9107;
-    // Orchestrator's pcap port number
+    // Orchestrator's default pcap port number
     static constexpr uint16_t PORT_LISTEN_PCAP = 9108;
     // Poll timer for quasi-blocking pcap communication
     static constexpr uint64_t PCAP_POLL_TIMEOUT_MS = 50;
+    // Maximum number of pcap dispatch threads
+    static constexpr uint16_t MAX_NUM_PCAP_THREADS = 16;
     // Wait time to send/recv data to/from all fragments
     static constexpr uint64_t DEFAULT_WAIT_TIME_MS = 1000;
+    // Hello intervals for which node state must be stable to converge
+    static constexpr uint32_t CONVERGENCE_QUIET_HELLOS = 3;
 
 private:
     // FSM states. These represent common tasks that need to
@@ -62,6 +73,7 @@ private:
         GRACEFUL_SHUTDOWN,
         FORCEFUL_SHUTDOWN,
         RESET,
+        RESET_FRAGMENTS,
     };
 
     // Fragment metadata
@@ -82,16 +94,34 @@ private:
     // Maps fragment IDs to metadata
     std::vector<fragment_metadata> fragments_;
 
-    // State for managing the pcap overlay
-    std::thread pcap_thread_;
+    // Maps a directed link (idx_a, idx_b), packed as ((idx_a << 16) |
+    // idx_b), to the NID of b in a's adjacency list. Rebuilt whenever
+    // the topology is created, so link lookups are O(1).
+    std::unordered_map<uint32_t, uint16_t> neighbor_ids_;
+    // Currently disabled links, packed as ((min_idx << 16) | max_idx),
+    // and the time (CLOCK_MONOTONIC) at which a link last changed state.
+    std::unordered_set<uint32_t> disabled_links_;
+    uint64_t last_link_change_ns_ = 0;
+
+    // State for managing the pcap overlay. Each pcap thread serves
+    // a shard of the fragments (fid % num_threads) using its own
+    // epoll instance, so pcap callbacks for any single fragment are
+    // always invoked in order, and from the same thread.
+    struct pcap_worker {
+        int epoll_fd = -1;                                      // Epoll FD (shard's pcap FDs)
+        message msg{};                                          // Message buffer (pcap)
+        std::thread thread;                                     // Thread handle
+    };
+    uint16_t num_pcap_workers_ = 0;                             // Number of pcap threads
+    std::unique_ptr<pcap_worker[]> pcap_workers_{};             // Worker ID -> State
     volatile bool pcap_thread_run_ = true;
-    error_code pcap_thread_error_ = error_code::NONE;
+    std::atomic<error_code> pcap_thread_error_{error_code::NONE};
 
     // Housekeeping
     message msg_ctrl_{};                                        // Message buffer (ctrl)
-    message msg_pcap_{};                                        // Message buffer (pcap)
     int listen_fd_ctrl_ = -1;                                   // Server ctrl socket FD
     int listen_fd_pcap_ = -1;                                   // Server pcap socket FD
+    uint16_t listen_port_ctrl_ = 0;                             // Bound ctrl port number
     state_t state_ = state_t::INIT;                             // The current FSM state
     testing::testcase *testcase_ = nullptr;                     // Pointer to current testcase
 
@@ -99,6 +129,21 @@ private:
     bool is_configured_ = false;                                // Configuration complete?
     std::string fragment_dir_{};                                // Fragment executable path
     bool autotest_mode_ = false;                                // Use the autotester mode?
+    uint16_t ctrl_port_ = PORT_LISTEN_CTRL;                     // Ctrl port (0: auto-allocate)
+    uint16_t pcap_port_ = PORT_LISTEN_PCAP;                     // Pcap port (0: auto-allocate)
+    networking::backend link_backend_ = (                       // Mixnet link I/O backend
+        networking::backend::SOCKET);
+    networking::transport link_transport_ = (                   // Mixnet link transport
+        networking::transport::TCP);
+    uint16_t num_io_threads_ = 1;                               // I/O threads per fragment
+    uint16_t num_pcap_threads_ = 1;                             // Pcap dispatch threads
+    bool track_latency_ = false;                                // Track one-way latencies?
+    latency_tracker latency_{};                                 // Per-flow latency histograms
+    std::string pcapng_dir_{};                                  // Fragment pcapng directory
+    bool pcapng_links_ = false;                                 // Capture link-level traffic?
+    bool use_zygote_ = false;                                   // Fork fragments from a zygote?
+    bool reuse_fragments_ = false;                              // Keep fragments across runs?
+    uint64_t setup_time_ms_ = 0;                                // Time to START_TESTCASE (ms)
     uint64_t timeout_connect_ms_ = DEFAULT_WAIT_TIME_MS;        // Setup connection timeout
     uint64_t timeout_communication_ms_ = DEFAULT_WAIT_TIME_MS;  // Regular send/recv timeout
 
@@ -115,6 +160,7 @@ private:
     error_code run_state_start_mixnet_server();
     error_code run_state_start_mixnet_clients();
     error_code run_state_resolve_mixnet_connections();
+    error_code run_state_reset_fragments();
 
     // Orchestrator methods
     void run_state_reset();
@@ -124,9 +170,18 @@ private:
      * Miscellaneous helper methods.
      */
     void destroy_sockets();
-    void pcap_thread_loop();
     void destroy_fragments(int signal);
 
+    std::vector<std::string> fragment_command_line() const;
+    error_code spawn_fragments(const uint16_t num_fragments);
+    error_code spawn_fragments_zygote(const uint16_t num_fragments);
+
+    error_code start_pcap_threads();
+    void stop_pcap_threads();
+    void pcap_thread_loop(pcap_worker& worker);
+    error_code pcap_recv_batch(const uint16_t fid, message& msg,
+                               const bool dispatch);
+
     void prepare_header(message& msg,
                         const uint16_t fid,
                         const message::type type);
@@ -161,6 +216,11 @@ private:
         const std::function<error_code(
             const uint16_t, const message&)>& lambda);
 
+    error_code lookup_link(const uint16_t idx_a, const uint16_t idx_b,
+                           uint16_t& b_nid_in_a, uint16_t& a_nid_in_b) const;
+    void record_link_state(const uint16_t idx_a, const uint16_t idx_b,
+                           const bool is_enabled);
+
     error_code foreach_fragment_recv_generic(
         const bool check_fragment_ids, const std::vector<int>& fds,
         const message::type type, const std::function<error_code(
@@ -168,6 +228,60 @@ private:
             const error_code connection_error);
 
 public:
+    // Run-time options (typically set from the command-line)
+    struct options {
+        bool autotest_mode = false;                             // Use the autotester mode?
+        uint16_t ctrl_port = PORT_LISTEN_CTRL;                  // Ctrl port (0: any free port)
+        uint16_t pcap_port = PORT_LISTEN_PCAP;                  // Pcap port (0: any free port)
+        networking::backend link_backend = (                    // Mixnet link I/O backend
+            networking::backend::SOCKET);
+        networking::transport link_transport = (                // Mixnet link transport
+            networking::transport::TCP);
+        uint16_t num_io_threads = 1;                            // I/O threads per fragment
+        uint16_t num_pcap_threads = 1;                          // Pcap dispatch threads (if more
+                                                                // than one, testcase::pcap() must
+                                                                // be thread-safe).
+        std::string pcapng_dir{};                               // Fragment pcapng directory
+        bool pcapng_links = false;                              // Capture link-level traffic?
+        bool track_latency = false;                             // Track one-way latencies of
+                                                                // injected, captured packets?
+        std::string latency_tag{};                              // If set, only track DATA packets
+                                                                // whose payload starts with it
+        bool use_zygote = false;                                // Fork fragments from a single,
+                                                                // pre-initialized fragment?
+        bool reuse_fragments = false;                           // Keep fragments alive across
+                                                                // runs (see release_fragments)?
+    };
+
+    // A packet to inject using send_packets()
+    struct packet_spec {
+        uint16_t src_idx;                                       // Source node index
+        uint16_t dst_idx;                                       // Destination node index
+        mixnet_packet_type_t type;                              // Packet type
+        std::string data{};                                     // Payload (DATA only)
+    };
+    // Node-reported control-plane state (see mixnet_report_state())
+    struct node_state {
+        bool has_reported = false;                              // Any state reported yet?
+        mixnet_address root_address = INVALID_MIXADDR;          // STP root
+        uint16_t path_length = 0;                               // Path length to the root
+        mixnet_address next_hop = INVALID_MIXADDR;              // Next hop towards the root
+        uint16_t lsdb_size = 0;                                 // Nodes in the link-state DB
+        uint64_t stable_ms = 0;                                 // Time since the last change
+        uint64_t last_change_us = 0;                            // Node start -> Last change
+        // Node-reported counters (see mixnet_report_counters())
+        uint64_t stp_packets_sent = 0;                          // STP packets sent
+        uint64_t lsa_packets_sent = 0;                          // LSA packets sent
+        uint64_t spf_runs = 0;                                  // Path computations
+    };
+    // A link state change (see change_link_states())
+    struct link_change {
+        uint16_t idx_a;                                         // First endpoint
+        uint16_t idx_b;                                         // Second endpoint
+        bool is_enabled;                                        // New link state
+    };
+
+    ~orchestrator();
     explicit orchestrator();
     DISALLOW_COPY_AND_ASSIGN(orchestrator);
 
@@ -176,7 +290,7 @@ public:
      * Configure the orchestrator with command-line arguments (e.g., server
      * address, autotest mode). Must be invoked before orchestrator::run().
      */
-    void configure(const std::string& bin_dir, const bool autotest_mode);
+    void configure(const std::string& bin_dir, const options& options);
 
     /**
      * Main orchestrator method. Once the virtual topology is set up and all
@@ -187,6 +301,27 @@ public:
      */
     error_code run(testing::testcase& testcase);
 
+    /**
+     * If options::reuse_fragments is set, fragments outlive a successful
+     * run(); the next run() then RESETs them (shutting down any surplus
+     * ones) and only rebuilds the Mixnet topology, skipping process and
+     * overlay setup. A run that needs more fragments than are available,
+     * or that fails, tears the fragments down as usual. This method shuts
+     * down any remaining fragments (also invoked on destruction).
+     */
+    void release_fragments();
+
+    /**
+     * Returns the one-way latency statistics collected so far (only
+     * populated if options::track_latency is set). Latencies are only
+     * measured for injected packets delivered at subscribed nodes.
+     */
+    const latency_tracker& latency() const { return latency_; }
+
+    // Returns the time (in ms) taken by the last run to set up the
+    // fragments and the topology, i.e., to reach START_TESTCASE.
+    uint64_t setup_time_ms() const { return setup_time_ms_; }
+
     /**
      * The methods that appear after this point are run-time configuration
      * parameters. They must be invoked AFTER control passes to testcase::
@@ -195,15 +330,45 @@ public:
     // Allows the orchestrator to "subscribe" to packet capture traffic.
     // Any packets that appear on the output (mixnet_send() to the user)
     // of a subscribed node will be sent back to the orchestrator and
-    // will invoke the registered pcap callback.
+    // will invoke the registered pcap callback. The optional filter is
+    // evaluated by the fragment, so only matching packets are shipped;
+    // packets truncated by filter.snaplen are passed to the testcase's
+    // pcap_truncated() callback (along with their capture length).
     error_code pcap_change_subscription(
-        const uint16_t idx, const bool subscribe);
+        const uint16_t idx, const bool subscribe,
+        const pcap_filter& filter=pcap_filter());
 
     // Enable/disable the link between two nodes
     error_code change_link_state(const uint16_t idx_a,
                                  const uint16_t idx_b,
                                  const bool is_enabled);
 
+    // Batched counterpart of change_link_state(). Every fragment gets
+    // its share of the batch in a single message, and all fragments
+    // are updated in the same control round, so the node at either
+    // end of every link observes the whole batch at once. If a link
+    // appears more than once, the last change wins.
+    error_code change_link_states(const std::vector<link_change>& changes);
+
+    // Queries the state (and counters) reported by every node (indexed
+    // by node).
+    error_code query_node_states(std::vector<node_state>& states);
+
+    // Returns whether the given node states describe a converged network.
+    // Within every component (i.e., over enabled links), all nodes must
+    // agree on a root that is itself a member, report their hop distance
+    // to it along a valid next hop, and know of at least every member in
+    // their link-state DB. Every node's state must also have been stable
+    // for CONVERGENCE_QUIET_HELLOS hello intervals, and, since failures
+    // are only detected by the reelection timer, any link state change
+    // must be at least a reelection interval (plus the same) old.
+    bool is_converged(const std::vector<node_state>& states) const;
+
+    // Polls node states until the network converges (returns true), or
+    // for at most timeout_ms (returns false). This requires nodes to use
+    // mixnet_report_state(); otherwise, it amounts to a fixed sleep.
+    bool await_convergence(const uint32_t timeout_ms);
+
     // Send a packet with source and destination addresses corresponding
     // to src_idx and dst_idx, respectively. The optional data_string
     // parameter allows you to specify the data to send.
@@ -211,6 +376,26 @@ public:
                            const uint16_t dst_idx,
                            const mixnet_packet_type_t type,
                            const std::string data_string="");
+
+    // Bulk counterpart of send_packet(). Packets are grouped by source
+    // node and shipped to fragments in as few control round-trips as
+    // possible; packets from the same source are injected in order.
+    error_code send_packets(const std::vector<packet_spec>& packets);
+
+    // Starts the traffic generator of node idx with the given profile,
+    // replacing its current one (if any). Packets are generated by the
+    // fragment itself, so neither the orchestrator nor the ctrl plane
+    // limit the offered load. An empty destination set draws uniformly
+    // from all other nodes. Statistics are reported at the end of the
+    // testcase (see testcase::traffic_stats()).
+    error_code start_traffic(const uint16_t idx,
+                             const traffic_profile& profile);
+
+    // Starts traffic generators according to a traffic matrix, where
+    // matrix[src][dst] is the mean rate (in pps) from src to dst. The
+    // remaining parameters are taken from the given profile.
+    error_code start_traffic(const traffic_profile& profile,
+        const std::vector<std::vector<uint32_t>>& matrix);
 };
 
 // Cleanup
@@ -0,0 +1,97 @@
+/**
+ * Copyright (C) 2023 Carnegie Mellon University
+ *
+ * This file is part of the Mixnet course project developed for
+ * the Computer Networks course (15-441/641) taught at Carnegie
+ * Mellon University.
+ *
+ * No part of the Mixnet project may be copied and/or distributed
+ * without the express permission of the 15-441/641 course staff.
+ */
+#ifndef FRAMEWORK_PCAP_FILTER_H_
+#define FRAMEWORK_PCAP_FILTER_H_
+
+#include "mixnet/address.h"
+#include "mixnet/packet.h"
+
+#include <algorithm>
+#include <stdint.h>
+#include <vector>
+
+namespace framework {
+
+/**
+ * Action taken by a fragment when its capture queue is full. BLOCK
+ * stalls the node thread for up to a timeout, then drops the packet.
+ */
+enum class pcap_overflow : uint8_t {
+    FAIL = 0,                                           // Terminate the node thread
+    DROP_NEWEST,                                        // Drop the packet being captured
+    DROP_OLDEST,                                        // Drop the oldest queued packet
+    BLOCK,                                              // Wait for space (with timeout)
+};
+
+/**
+ * Packet capture filter, evaluated by fragments on every packet sent
+ * to the user port before it is mirrored to the orchestrator. A packet
+ * is captured iff its type is in the type mask and its source (resp.
+ * destination) address is in the source (resp. destination) address
+ * set; empty sets match any address. Of the matching packets, only one
+ * in every sample_rate is captured, truncated to snaplen bytes.
+ */
+struct pcap_filter {
+    // Constant parameters
+    static constexpr uint16_t ALL_TYPES = 0xFFFF;
+    static constexpr uint16_t MAX_NUM_ADDRS = 1024;
+
+    uint16_t type_mask = ALL_TYPES;                     // Bit i set: capture type i
+    uint16_t sample_rate = 1;                           // Capture 1-in-N matching packets
+    uint16_t snaplen = 0;                               // Max captured size (0: unlimited)
+    std::vector<mixnet_address> src_addrs;              // Source addresses (sorted)
+    std::vector<mixnet_address> dst_addrs;              // Destination addresses (sorted)
+
+    static constexpr uint16_t type_bit(const mixnet_packet_type_t type) {
+        return ((type < 16) ? (1 << type) : 0);
+    }
+
+    // Sorts the address sets (must be invoked before matches())
+    void finalize() {
+        std::sort(src_addrs.begin(), src_addrs.end());
+        std::sort(dst_addrs.begin(), dst_addrs.end());
+    }
+
+    // Returns the number of bytes to capture for the given packet
+    uint16_t caplen(const mixnet_packet *const packet) const {
+        const uint16_t limit = std::max(snaplen, MIN_MIXNET_PACKET_SIZE);
+        return ((snaplen == 0) ? packet->total_size :
+                std::min(packet->total_size, limit));
+    }
+
+    /**
+     * Returns whether the given (valid) user packet matches this filter,
+     * ignoring sampling. Packets without a routing header never match
+     * a filter with non-empty address sets.
+     */
+    bool matches(const mixnet_packet *const packet) const {
+        if ((type_mask & type_bit(packet->type)) == 0) { return false; }
+        if (src_addrs.empty() && dst_addrs.empty()) { return true; }
+
+        const bool has_routing_header = (
+            ((packet->type == PACKET_TYPE_DATA) ||
+             (packet->type == PACKET_TYPE_PING)) &&
+            (packet->total_size >= (sizeof(mixnet_packet) +
+                                    sizeof(mixnet_packet_routing_header))));
+
+        if (!has_routing_header) { return false; }
+        auto rh = reinterpret_cast<const mixnet_packet_routing_header*>(
+                                                    packet->payload());
+        return ((src_addrs.empty() || std::binary_search(
+                    src_addrs.begin(), src_addrs.end(), rh->src_address)) &&
+                (dst_addrs.empty() || std::binary_search(
+                    dst_addrs.begin(), dst_addrs.end(), rh->dst_address)));
+    }
+};
+
+} // namespace framework
+
+#endif // FRAMEWORK_PCAP_FILTER_H_
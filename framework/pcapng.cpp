@@ -0,0 +1,219 @@
+/**
+ * Copyright (C) 2023 Carnegie Mellon University
+ *
+ * This file is part of the Mixnet course project developed for
+ * the Computer Networks course (15-441/641) taught at Carnegie
+ * Mellon University.
+ *
+ * No part of the Mixnet project may be copied and/or distributed
+ * without the express permission of the 15-441/641 course staff.
+ */
+#include "pcapng.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace framework {
+
+/**
+ * pcapng block layouts (see draft-ietf-opsawg-pcapng). All blocks
+ * and options are padded to 32 bits, and every block ends with a
+ * copy of its total length.
+ */
+static constexpr uint32_t BLOCK_TYPE_SHB = 0x0A0D0D0A;
+static constexpr uint32_t BLOCK_TYPE_IDB = 0x00000001;
+static constexpr uint32_t BLOCK_TYPE_EPB = 0x00000006;
+static constexpr uint32_t BYTE_ORDER_MAGIC = 0x1A2B3C4D;
+
+static constexpr uint16_t OPT_ENDOFOPT = 0;
+static constexpr uint16_t OPT_IF_NAME = 2;
+static constexpr uint16_t OPT_IF_TSRESOL = 9;
+static constexpr uint16_t OPT_EPB_FLAGS = 2;
+
+struct block_header {
+    uint32_t block_type;
+    uint32_t total_length;
+};
+struct shb_body {
+    uint32_t byte_order_magic;
+    uint16_t major_version;
+    uint16_t minor_version;
+    int64_t section_length;
+};
+struct idb_body {
+    uint16_t link_type;
+    uint16_t reserved;
+    uint32_t snap_len;
+};
+struct epb_body {
+    uint32_t interface_id;
+    uint32_t timestamp_high;
+    uint32_t timestamp_low;
+    uint32_t captured_length;
+    uint32_t original_length;
+};
+struct option_header {
+    uint16_t code;
+    uint16_t length;
+};
+
+static size_t pad32(const size_t length) { return ((length + 3) & ~3); }
+
+/**
+ * Helper class to serialize a block into reserved space.
+ */
+class block_builder final {
+private:
+    char *const start_;
+    char *cursor_;
+
+public:
+    explicit block_builder(char *start, const uint32_t type) :
+        start_(start), cursor_(start + sizeof(block_header)) {
+        reinterpret_cast<block_header*>(start_)->block_type = type;
+    }
+    void append(const void *data, const size_t length) {
+        memcpy(cursor_, data, length);
+        memset(cursor_ + length, 0, pad32(length) - length);
+        cursor_ += pad32(length);
+    }
+    void option(const uint16_t code, const void *data,
+                const uint16_t length) {
+        const option_header header{code, length};
+        append(&header, sizeof(header));
+        if (length != 0) { append(data, length); }
+    }
+    // Writes the trailing length; returns the block's size
+    uint32_t finish() {
+        const uint32_t length = static_cast<uint32_t>(
+            (cursor_ - start_) + sizeof(uint32_t));
+
+        memcpy(cursor_, &length, sizeof(length));
+        reinterpret_cast<block_header*>(start_)->total_length = length;
+        return length;
+    }
+};
+
+pcapng_writer::pcapng_writer() : page_size_(sysconf(_SC_PAGESIZE)) {}
+
+pcapng_writer::~pcapng_writer() {
+    if (window_ != nullptr) { munmap(window_, WINDOW_SIZE); }
+    if (fd_ != -1) {
+        // Trim the file to the data actually written
+        int rc = ftruncate(fd_, window_base_ + window_pos_);
+        (void) rc; // Nothing more we can do
+        close(fd_);
+    }
+}
+
+bool pcapng_writer::map_window(const size_t base) {
+    if (window_ != nullptr) { munmap(window_, WINDOW_SIZE); }
+    window_ = nullptr;
+
+    // Grow the file to cover the new window, then map it
+    if (ftruncate(fd_, base + WINDOW_SIZE) < 0) { return false; }
+    void *window = mmap(nullptr, WINDOW_SIZE, PROT_READ | PROT_WRITE,
+                        MAP_SHARED, fd_, base);
+    if (window == MAP_FAILED) { return false; }
+
+    window_ = static_cast<char*>(window);
+    window_base_ = base;
+    return true;
+}
+
+char *pcapng_writer::reserve(const size_t length) {
+    if (window_ == nullptr) { return nullptr; }
+    if ((window_pos_ + length) > WINDOW_SIZE) {
+        // Slide the window forward (mmap offsets must be page-aligned)
+        const size_t offset = (window_base_ + window_pos_);
+        const size_t base = (offset & ~(page_size_ - 1));
+        if (!map_window(base)) { return nullptr; }
+        window_pos_ = (offset - base);
+    }
+    char *ptr = (window_ + window_pos_);
+    window_pos_ += length;
+    return ptr;
+}
+
+bool pcapng_writer::write_headers(const uint16_t num_neighbors,
+                                  const mixnet_address node_addr) {
+    // Section header block
+    char *ptr = reserve(sizeof(block_header) + sizeof(shb_body) +
+                        sizeof(uint32_t));
+    if (ptr == nullptr) { return false; }
+
+    block_builder shb(ptr, BLOCK_TYPE_SHB);
+    const shb_body shb_body{BYTE_ORDER_MAGIC, 1, 0, -1};
+    shb.append(&shb_body, sizeof(shb_body));
+    shb.finish();
+
+    // Interface description blocks (one per port)
+    for (uint16_t port = 0; port <= num_neighbors; port++) {
+        std::string name = ("node" + std::to_string(node_addr) + "-" + (
+            (port == num_neighbors) ? "user" : ("port" + std::to_string(port))));
+
+        ptr = reserve(sizeof(block_header) + sizeof(idb_body) +
+                      (3 * sizeof(option_header)) + pad32(name.size()) +
+                      sizeof(uint32_t) + sizeof(uint32_t));
+        if (ptr == nullptr) { return false; }
+
+        block_builder idb(ptr, BLOCK_TYPE_IDB);
+        const idb_body idb_body{LINKTYPE_USER0, 0, MAX_MIXNET_PACKET_SIZE};
+        const uint8_t tsresol = 9; // Nanoseconds
+
+        idb.append(&idb_body, sizeof(idb_body));
+        idb.option(OPT_IF_NAME, name.data(), name.size());
+        idb.option(OPT_IF_TSRESOL, &tsresol, sizeof(tsresol));
+        idb.option(OPT_ENDOFOPT, nullptr, 0);
+        idb.finish();
+        num_interfaces_++;
+    }
+    return true;
+}
+
+std::unique_ptr<pcapng_writer> pcapng_writer::create(
+    const std::string& path, const uint16_t num_neighbors,
+    const mixnet_address node_addr) {
+    auto writer = std::make_unique<pcapng_writer>();
+
+    writer->fd_ = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if ((writer->fd_ < 0) || !writer->map_window(0) ||
+        !writer->write_headers(num_neighbors, node_addr)) {
+        writer.reset();
+    }
+    return writer;
+}
+
+bool pcapng_writer::write(const uint16_t port, const direction direction,
+                          const mixnet_packet *const packet) {
+    if (port >= num_interfaces_) { return false; }
+
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    const uint64_t timestamp_ns = ((static_cast<uint64_t>(ts.tv_sec) *
+                                    1000000000ULL) + ts.tv_nsec);
+
+    const uint32_t length = packet->total_size;
+    char *ptr = reserve(sizeof(block_header) + sizeof(epb_body) +
+                        pad32(length) + (2 * sizeof(option_header)) +
+                        sizeof(uint32_t) + sizeof(uint32_t));
+    if (ptr == nullptr) { return false; }
+
+    block_builder epb(ptr, BLOCK_TYPE_EPB);
+    const epb_body epb_body{port,
+        static_cast<uint32_t>(timestamp_ns >> 32),
+        static_cast<uint32_t>(timestamp_ns), length, length};
+
+    const uint32_t flags = static_cast<uint32_t>(direction);
+    epb.append(&epb_body, sizeof(epb_body));
+    epb.append(packet, length);
+    epb.option(OPT_EPB_FLAGS, &flags, sizeof(flags));
+    epb.option(OPT_ENDOFOPT, nullptr, 0);
+    epb.finish();
+    return true;
+}
+
+} // namespace framework
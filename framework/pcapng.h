@@ -0,0 +1,91 @@
+/**
+ * Copyright (C) 2023 Carnegie Mellon University
+ *
+ * This file is part of the Mixnet course project developed for
+ * the Computer Networks course (15-441/641) taught at Carnegie
+ * Mellon University.
+ *
+ * No part of the Mixnet project may be copied and/or distributed
+ * without the express permission of the 15-441/641 course staff.
+ */
+#ifndef FRAMEWORK_PCAPNG_H_
+#define FRAMEWORK_PCAPNG_H_
+
+#include "mixnet/address.h"
+#include "mixnet/packet.h"
+
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+namespace framework {
+
+// Helper macros
+#define DISALLOW_COPY_AND_ASSIGN(TypeName)                  \
+    TypeName(const TypeName&) = delete;                     \
+    void operator=(const TypeName&) = delete
+
+/**
+ * Writes Mixnet packets to a pcapng file, for offline analysis with
+ * Wireshark/tshark. The file contains one interface per node port
+ * (the last one being the user-level port), all using LINKTYPE_USER0
+ * and nanosecond timestamps; a dissector may be assigned to DLT 147.
+ *
+ * Blocks are written directly into a file-backed mmap'd window that
+ * slides forward (growing the file) as it fills up, so writing does
+ * not involve a syscall per packet. Not thread-safe.
+ */
+class pcapng_writer final {
+public:
+    // Packet direction (relative to the node)
+    enum class direction : uint8_t {
+        INBOUND = 1, OUTBOUND = 2,
+    };
+    // Constant parameters
+    static constexpr uint16_t LINKTYPE_USER0 = 147;
+    static constexpr size_t WINDOW_SIZE = (4 << 20);
+
+private:
+    int fd_ = -1;                                       // File descriptor
+    char *window_ = nullptr;                            // Mapped window
+    size_t window_base_ = 0;                            // File offset of the window
+    size_t window_pos_ = 0;                             // Write offset in the window
+    size_t page_size_ = 0;                              // System page size
+    uint32_t num_interfaces_ = 0;                       // Number of IDBs written
+
+    /**
+     * Internal helper methods.
+     */
+    bool map_window(const size_t base);
+    char *reserve(const size_t length);
+    bool write_headers(const uint16_t num_neighbors,
+                       const mixnet_address node_addr);
+
+public:
+    ~pcapng_writer();
+    DISALLOW_COPY_AND_ASSIGN(pcapng_writer);
+    explicit pcapng_writer();
+
+    /**
+     * Creates the capture file at the given path for a node with the
+     * given number of neighbors. Returns nullptr on failure.
+     */
+    static std::unique_ptr<pcapng_writer> create(
+        const std::string& path, const uint16_t num_neighbors,
+        const mixnet_address node_addr);
+
+    /**
+     * Appends a packet seen on the given port (num_neighbors denotes
+     * the user-level port). Returns false on failure.
+     */
+    bool write(const uint16_t port, const direction direction,
+               const mixnet_packet *const packet);
+};
+
+// Cleanup
+#undef DISALLOW_COPY_AND_ASSIGN
+
+} // namespace framework
+
+#endif // FRAMEWORK_PCAPNG_H_
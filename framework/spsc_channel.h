@@ -0,0 +1,114 @@
+/**
+ * Copyright (C) 2023 Carnegie Mellon University
+ *
+ * This file is part of the Mixnet course project developed for
+ * the Computer Networks course (15-441/641) taught at Carnegie
+ * Mellon University.
+ *
+ * No part of the Mixnet project may be copied and/or distributed
+ * without the express permission of the 15-441/641 course staff.
+ */
+#ifndef FRAMEWORK_SPSC_CHANNEL_H_
+#define FRAMEWORK_SPSC_CHANNEL_H_
+
+#include "spsc_queue.h"
+
+#include <atomic>
+#include <linux/futex.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace framework {
+
+// Helper macros
+#define DISALLOW_COPY_AND_ASSIGN(TypeName)                  \
+    TypeName(const TypeName&) = delete;                     \
+    void operator=(const TypeName&) = delete
+
+/**
+ * SPSC queue with an optional blocking consumer. The consumer parks
+ * on a futex only after announcing that it is about to sleep, so the
+ * producer makes a syscall only on an empty -> non-empty transition
+ * that races with a sleeping consumer; uncontended pushes and pops
+ * never enter the kernel. close() may be invoked by any thread, and
+ * lets a blocked consumer drain the remaining elements and return.
+ */
+template<typename T>
+class spsc_channel final {
+private:
+    spsc_queue<T> queue_;                               // Underlying ring
+    std::atomic<uint32_t> sleeping_{0};                 // Futex word (1: consumer parked)
+    std::atomic<bool> closed_{false};                   // Channel closed?
+
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+                  "Futex word must be a plain 32-bit integer");
+
+    void futex(const int op, const uint32_t value) {
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&sleeping_),
+                op, value, nullptr, nullptr, 0);
+    }
+    // Wakes the consumer if it is (about to be) parked
+    void wake() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleeping_.load() != 0) {
+            sleeping_.store(0);
+            futex(FUTEX_WAKE_PRIVATE, 1);
+        }
+    }
+
+public:
+    DISALLOW_COPY_AND_ASSIGN(spsc_channel);
+    explicit spsc_channel(const size_t capacity) : queue_(capacity) {}
+
+    /**
+     * Producer API. Returns false if the channel is full.
+     */
+    bool try_push(const T& value) {
+        if (!queue_.try_push(value)) { return false; }
+        wake(); return true;
+    }
+    // Returns the number of elements pushed (see spsc_queue)
+    size_t try_push_bulk(const T *values, const size_t count) {
+        const size_t num_pushed = queue_.try_push_bulk(values, count);
+        if (num_pushed != 0) { wake(); }
+        return num_pushed;
+    }
+
+    /**
+     * Consumer API. try_pop() never blocks; pop() blocks until an
+     * element is available, or returns false once the channel is
+     * closed and fully drained.
+     */
+    bool try_pop(T& value) { return queue_.try_pop(value); }
+
+    bool pop(T& value) {
+        while (!queue_.try_pop(value)) {
+            if (closed_.load()) { return queue_.try_pop(value); }
+
+            // Announce that we are about to sleep, then re-check
+            // so that a concurrent push (or close) isn't missed.
+            sleeping_.store(1);
+            if (!queue_.empty() || closed_.load()) {
+                sleeping_.store(0); continue;
+            }
+            futex(FUTEX_WAIT_PRIVATE, 1);
+            sleeping_.store(0);
+        }
+        return true;
+    }
+
+    /**
+     * Closes the channel, waking up a blocked consumer.
+     */
+    void close() { closed_.store(true); wake(); }
+    bool is_closed() const { return closed_.load(); }
+};
+
+// Cleanup
+#undef DISALLOW_COPY_AND_ASSIGN
+
+} // namespace framework
+
+#endif // FRAMEWORK_SPSC_CHANNEL_H_
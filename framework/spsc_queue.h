@@ -0,0 +1,123 @@
+/**
+ * Copyright (C) 2023 Carnegie Mellon University
+ *
+ * This file is part of the Mixnet course project developed for
+ * the Computer Networks course (15-441/641) taught at Carnegie
+ * Mellon University.
+ *
+ * No part of the Mixnet project may be copied and/or distributed
+ * without the express permission of the 15-441/641 course staff.
+ */
+#ifndef FRAMEWORK_SPSC_QUEUE_H_
+#define FRAMEWORK_SPSC_QUEUE_H_
+
+#include <assert.h>
+#include <atomic>
+#include <memory>
+#include <stddef.h>
+
+namespace framework {
+
+// Helper macros
+#define DISALLOW_COPY_AND_ASSIGN(TypeName)                  \
+    TypeName(const TypeName&) = delete;                     \
+    void operator=(const TypeName&) = delete
+
+/**
+ * Bounded, lock-free single-producer/single-consumer queue. The head
+ * (consumer) and tail (producer) indices live on separate cache lines,
+ * and each side caches the other's index so that the shared line is
+ * only read when the queue appears to be full (or empty).
+ *
+ * @tparam T: Element type (should be cheap to copy, e.g. a pointer).
+ */
+template<typename T>
+class spsc_queue final {
+private:
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    const size_t mask_;                                 // Capacity - 1
+    std::unique_ptr<T[]> slots_;                        // Ring storage
+    // Consumer state
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> head_{0};
+    size_t cached_tail_ = 0;                            // Consumer's view of tail
+    // Producer state
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail_{0};
+    size_t cached_head_ = 0;                            // Producer's view of head
+
+public:
+    DISALLOW_COPY_AND_ASSIGN(spsc_queue);
+    explicit spsc_queue(const size_t capacity) : mask_(capacity - 1),
+        slots_(std::make_unique<T[]>(capacity)) {
+        // Capacity must be a non-zero power of two
+        assert((capacity != 0) && ((capacity & mask_) == 0));
+    }
+
+    size_t capacity() const { return (mask_ + 1); }
+
+    /**
+     * Producer API. Returns false if the queue is full.
+     */
+    bool try_push(const T& value) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if ((tail - cached_head_) > mask_) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if ((tail - cached_head_) > mask_) { return false; }
+        }
+        slots_[tail & mask_] = value;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Pushes up to count elements with a single release of the tail.
+     * Returns the number of elements pushed (0 if the queue is full).
+     */
+    size_t try_push_bulk(const T *values, const size_t count) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        size_t space = (capacity() - (tail - cached_head_));
+        if (space < count) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            space = (capacity() - (tail - cached_head_));
+        }
+        const size_t num_pushed = ((space < count) ? space : count);
+        for (size_t i = 0; i < num_pushed; i++) {
+            slots_[(tail + i) & mask_] = values[i];
+        }
+        if (num_pushed != 0) {
+            tail_.store(tail + num_pushed, std::memory_order_release);
+        }
+        return num_pushed;
+    }
+
+    /**
+     * Consumer API. Returns false if the queue is empty.
+     */
+    bool try_pop(T& value) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head == cached_tail_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head == cached_tail_) { return false; }
+        }
+        value = slots_[head & mask_];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Approximate occupancy (exact if called by either endpoint
+     * while the other one is quiescent).
+     */
+    size_t size() const {
+        return (tail_.load(std::memory_order_acquire) -
+                head_.load(std::memory_order_acquire));
+    }
+    bool empty() const { return (size() == 0); }
+};
+
+// Cleanup
+#undef DISALLOW_COPY_AND_ASSIGN
+
+} // namespace framework
+
+#endif // FRAMEWORK_SPSC_QUEUE_H_
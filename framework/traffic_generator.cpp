@@ -0,0 +1,152 @@
+/**
+ * Copyright (C) 2023 Carnegie Mellon University
+ *
+ * This file is part of the Mixnet course project developed for
+ * the Computer Networks course (15-441/641) taught at Carnegie
+ * Mellon University.
+ *
+ * No part of the Mixnet project may be copied and/or distributed
+ * without the express permission of the 15-441/641 course staff.
+ */
+#include "traffic_generator.h"
+
+#include "latency.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdlib.h>
+#include <string.h>
+
+namespace framework {
+
+error_code traffic_generator::start(
+    message::request::traffic_profile *const p) {
+    stop(); // Replace the current profile
+
+    // Validate the profile
+    if (((p->type != PACKET_TYPE_DATA) && (p->type != PACKET_TYPE_PING)) ||
+        (p->min_data_length > p->max_data_length) ||
+        (p->max_data_length > MAX_MIXNET_DATA_SIZE) ||
+        (p->num_dsts == 0)) {
+        return error_code::MALFORMED_MESSAGE;
+    }
+    type_ = p->type;
+    arrival_ = p->arrival;
+    rate_pps_ = p->rate_pps;
+    duration_ms_ = p->duration_ms;
+    min_data_length_ = p->min_data_length;
+    max_data_length_ = p->max_data_length;
+    seed_ = p->seed;
+
+    // Build the cumulative weight table
+    dsts_.clear();
+    uint64_t total_weight = 0;
+    auto dsts = p->dsts();
+    for (uint16_t i = 0; i < p->num_dsts; i++) {
+        if (dsts[i].weight == 0) { continue; }
+        total_weight += dsts[i].weight;
+        dsts_.push_back(destination{dsts[i].mixaddr, total_weight});
+    }
+    if (dsts_.empty()) { return error_code::MALFORMED_MESSAGE; }
+
+    keep_running_ = true;
+    thread_ = std::thread(&traffic_generator::run, this);
+    return error_code::NONE;
+}
+
+void traffic_generator::stop() {
+    keep_running_ = false;
+    if (thread_.joinable()) { thread_.join(); }
+}
+
+mixnet_packet *traffic_generator::build_packet(
+    std::mt19937_64& rng, const uint64_t seq) const {
+    mixnet_packet *packet = static_cast<mixnet_packet*>(
+                        malloc(MAX_MIXNET_PACKET_SIZE));
+    if (packet == NULL) { return NULL; }
+
+    // Pick a destination (weighted)
+    const uint64_t r = std::uniform_int_distribution<uint64_t>(
+        0, (dsts_.back().cumulative_weight - 1))(rng);
+
+    auto dst = std::upper_bound(dsts_.begin(), dsts_.end(), r,
+        [] (const uint64_t value, const destination& d) {
+            return (value < d.cumulative_weight); });
+
+    auto routing_header = reinterpret_cast<
+        mixnet_packet_routing_header*>(packet->payload());
+
+    routing_header->src_address = src_mixaddr_;
+    routing_header->dst_address = dst->mixaddr;
+    routing_header->route_length = 0;
+    routing_header->hop_index = 0;
+
+    uint16_t total_size = (sizeof(mixnet_packet) +
+                           sizeof(mixnet_packet_routing_header));
+    if (type_ == PACKET_TYPE_DATA) {
+        const uint16_t data_length = std::uniform_int_distribution<
+            uint16_t>(min_data_length_, max_data_length_)(rng);
+
+        memset(routing_header->route(), static_cast<int>(seq & 0xFF),
+               data_length);
+        total_size += data_length;
+    }
+    packet->type = type_;
+    packet->total_size = total_size;
+    return packet;
+}
+
+void traffic_generator::run() {
+    std::mt19937_64 rng(seed_ != 0 ? seed_ : std::random_device{}());
+    std::exponential_distribution<double> gap_dist(
+        (rate_pps_ != 0) ? rate_pps_ : 1);
+
+    const double mean_gap_ns = ((rate_pps_ != 0) ? (1e9 / rate_pps_) : 0);
+    const uint64_t start_ns = monotonic_ns();
+    const uint64_t end_ns = (start_ns + (duration_ms_ * 1000000ULL));
+    uint64_t num_sent = 0, num_drops = 0;
+    double next_ns = start_ns; // Next scheduled injection
+    uint64_t now_ns = start_ns;
+
+    while (keep_running_.load(std::memory_order_relaxed) &&
+           ((now_ns = monotonic_ns()) < end_ns)) {
+        // Rate-limited, and the next packet isn't due yet
+        if ((rate_pps_ != 0) && (now_ns < next_ns)) {
+            const uint64_t wait_ns = std::min<uint64_t>(
+                (next_ns - now_ns), (end_ns - now_ns));
+
+            if (wait_ns > SPIN_THRESHOLD_NS) {
+                std::this_thread::sleep_for(std::chrono::nanoseconds(
+                    wait_ns - SPIN_THRESHOLD_NS));
+            }
+            else { std::this_thread::yield(); }
+            continue;
+        }
+        mixnet_packet *packet = build_packet(rng, (num_sent + num_drops));
+        if (packet == NULL) { break; }
+
+        // Saturating, so wait for the node to make space
+        if (rate_pps_ == 0) {
+            while (!channel_.try_push(packet)) {
+                if (!keep_running_.load(std::memory_order_relaxed) ||
+                    (monotonic_ns() >= end_ns)) {
+                    free(packet); packet = NULL; break;
+                }
+                std::this_thread::yield();
+            }
+            if (packet != NULL) { num_sent++; }
+            continue;
+        }
+        // Offered load exceeds what the node consumes
+        if (channel_.try_push(packet)) { num_sent++; }
+        else { free(packet); num_drops++; }
+
+        next_ns += ((arrival_ == traffic_arrival::POISSON) ?
+                    (gap_dist(rng) * 1e9) : mean_gap_ns);
+    }
+    stats_.num_sent += num_sent;
+    stats_.num_drops += num_drops;
+    stats_.duration_ns += (std::min(now_ns, end_ns) - start_ns);
+}
+
+} // namespace framework
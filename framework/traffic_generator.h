@@ -0,0 +1,100 @@
+/**
+ * Copyright (C) 2023 Carnegie Mellon University
+ *
+ * This file is part of the Mixnet course project developed for
+ * the Computer Networks course (15-441/641) taught at Carnegie
+ * Mellon University.
+ *
+ * No part of the Mixnet project may be copied and/or distributed
+ * without the express permission of the 15-441/641 course staff.
+ */
+#ifndef FRAMEWORK_TRAFFIC_GENERATOR_H_
+#define FRAMEWORK_TRAFFIC_GENERATOR_H_
+
+#include "error.h"
+#include "message.h"
+#include "spsc_channel.h"
+#include "traffic_profile.h"
+#include "mixnet/address.h"
+#include "mixnet/packet.h"
+
+#include <atomic>
+#include <random>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+namespace framework {
+
+// Helper macros
+#define DISALLOW_COPY_AND_ASSIGN(TypeName)                  \
+    TypeName(const TypeName&) = delete;                     \
+    void operator=(const TypeName&) = delete
+
+/**
+ * Fragment-local traffic generator. Runs a load profile (see
+ * traffic_profile.h) on a dedicated thread, injecting packets into
+ * a channel that the node thread drains as part of its user port.
+ * At a fixed rate, packets that find the channel full are dropped
+ * (and counted); when saturating, the generator waits for space.
+ */
+class traffic_generator final {
+public:
+    // Constant parameters
+    static constexpr uint64_t SPIN_THRESHOLD_NS = 100000;
+    typedef spsc_channel<mixnet_packet*> packet_channel;
+
+private:
+    // Destination with its cumulative weight
+    struct destination {
+        mixnet_address mixaddr;
+        uint64_t cumulative_weight;
+    };
+
+    packet_channel& channel_;                           // Channel to inject into
+    const mixnet_address src_mixaddr_;                  // Node's mixnet address
+
+    // Current profile
+    mixnet_packet_type_t type_ = PACKET_TYPE_DATA;      // Packet type
+    traffic_arrival arrival_ = traffic_arrival::CONSTANT;
+    uint32_t rate_pps_ = 0;                             // Mean rate (0: saturate)
+    uint32_t duration_ms_ = 0;                          // Generation period
+    uint16_t min_data_length_ = 0;                      // Smallest payload
+    uint16_t max_data_length_ = 0;                      // Largest payload
+    uint32_t seed_ = 0;                                 // PRNG seed (0: random)
+    std::vector<destination> dsts_;                     // Destination set
+
+    std::thread thread_;                                // Generator thread
+    std::atomic<bool> keep_running_{false};             // ITC synchronization
+    traffic_stats stats_{};                             // Accumulated statistics
+
+    void run();
+    mixnet_packet *build_packet(std::mt19937_64& rng,
+                                const uint64_t seq) const;
+
+public:
+    DISALLOW_COPY_AND_ASSIGN(traffic_generator);
+    explicit traffic_generator(packet_channel& channel,
+                               const mixnet_address src_mixaddr) :
+                               channel_(channel), src_mixaddr_(src_mixaddr) {}
+    ~traffic_generator() { stop(); }
+
+    /**
+     * Starts running the given profile, replacing the current one
+     * (if any). Returns MALFORMED_MESSAGE for an invalid profile.
+     */
+    error_code start(message::request::traffic_profile *const p);
+
+    // Stops generation (if running) and waits for the thread to exit
+    void stop();
+
+    // Accumulated statistics (only valid while stopped)
+    const traffic_stats& stats() const { return stats_; }
+};
+
+// Cleanup
+#undef DISALLOW_COPY_AND_ASSIGN
+
+} // namespace framework
+
+#endif // FRAMEWORK_TRAFFIC_GENERATOR_H_
@@ -0,0 +1,69 @@
+/**
+ * Copyright (C) 2023 Carnegie Mellon University
+ *
+ * This file is part of the Mixnet course project developed for
+ * the Computer Networks course (15-441/641) taught at Carnegie
+ * Mellon University.
+ *
+ * No part of the Mixnet project may be copied and/or distributed
+ * without the express permission of the 15-441/641 course staff.
+ */
+#ifndef FRAMEWORK_TRAFFIC_PROFILE_H_
+#define FRAMEWORK_TRAFFIC_PROFILE_H_
+
+#include "mixnet/packet.h"
+
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+namespace framework {
+
+/**
+ * Inter-arrival process of generated packets.
+ */
+enum class traffic_arrival : uint8_t {
+    CONSTANT = 0,                                       // Fixed inter-arrival time
+    POISSON,                                            // Exponential inter-arrival times
+};
+
+/**
+ * Load profile for a fragment's local traffic generator. The fragment
+ * injects DATA (or PING) packets directly into its node's user port at
+ * the given rate for the given duration; a rate of 0 saturates the node
+ * (i.e., packets are injected as fast as the node consumes them). Each
+ * packet's destination is drawn from the (weighted) destination set,
+ * and its payload size uniformly from [min_data_length, max_data_length].
+ */
+struct traffic_profile {
+    // Constant parameters
+    static constexpr uint16_t MAX_NUM_DSTS = 1024;
+
+    mixnet_packet_type_t type = PACKET_TYPE_DATA;       // DATA or PING
+    traffic_arrival arrival = traffic_arrival::CONSTANT;// Inter-arrival process
+    uint32_t rate_pps = 0;                              // Mean rate (0: saturate)
+    uint32_t duration_ms = 1000;                        // Generation period
+    uint16_t min_data_length = 0;                       // Smallest payload (DATA only)
+    uint16_t max_data_length = 0;                       // Largest payload (DATA only)
+    uint32_t seed = 0;                                  // PRNG seed (0: random)
+    std::vector<std::pair<uint16_t, uint32_t>> dsts;    // (Node index, Weight) pairs
+};
+
+/**
+ * Traffic generation statistics reported by a fragment at the end
+ * of the testcase (accumulated over all the profiles it ran).
+ */
+struct traffic_stats {
+    uint64_t num_sent = 0;                              // Packets injected
+    uint64_t num_drops = 0;                             // Packets dropped (user MQ full)
+    uint64_t duration_ns = 0;                           // Time spent generating
+
+    // Achieved injection rate (in packets/sec)
+    double rate_pps() const {
+        return ((duration_ns == 0) ? 0 : ((num_sent * 1e9) / duration_ns));
+    }
+};
+
+} // namespace framework
+
+#endif // FRAMEWORK_TRAFFIC_PROFILE_H_
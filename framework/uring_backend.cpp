@@ -0,0 +1,601 @@
+/**
+ * Copyright (C) 2023 Carnegie Mellon University
+ *
+ * This file is part of the Mixnet course project developed for
+ * the Computer Networks course (15-441/641) taught at Carnegie
+ * Mellon University.
+ *
+ * No part of the Mixnet project may be copied and/or distributed
+ * without the express permission of the 15-441/641 course staff.
+ */
+#include "uring_backend.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef MIXNET_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif // MIXNET_IO_URING
+
+namespace framework {
+
+#ifdef MIXNET_IO_URING
+
+/**
+ * Helper macros.
+ */
+#define LOAD_ACQUIRE(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define STORE_RELEASE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+// Completion tags (upper 32 bits of user_data)
+static constexpr uint64_t TAG_RECV = 1;
+static constexpr uint64_t TAG_SEND = 2;
+static constexpr uint64_t TAG_PROBE = 3;
+static constexpr uint64_t TAG_CANCEL = 4;
+// Provided buffer group ID used for every port
+static constexpr uint16_t RX_BUFFER_GROUP = 0;
+
+/**
+ * Raw io_uring state. We drive the rings directly (without liburing)
+ * to avoid adding an external dependency to the build.
+ */
+struct uring_backend::ring {
+    int fd = -1;                                        // Ring FD
+    uint32_t sq_entries = 0;                            // SQ size
+    // Mappings
+    void *sq_map = MAP_FAILED; size_t sq_map_size = 0;
+    void *cq_map = MAP_FAILED; size_t cq_map_size = 0;
+    io_uring_sqe *sqes = nullptr; size_t sqes_size = 0;
+    io_uring_buf_ring *buf_ring = nullptr; size_t buf_ring_size = 0;
+    // SQ pointers
+    uint32_t *sq_head = nullptr, *sq_tail = nullptr;
+    uint32_t *sq_mask = nullptr, *sq_array = nullptr;
+    // CQ pointers
+    uint32_t *cq_head = nullptr, *cq_tail = nullptr;
+    uint32_t *cq_mask = nullptr; io_uring_cqe *cqes = nullptr;
+    // Provided buffer ring tail (local copy)
+    uint16_t buf_tail = 0;
+
+    ~ring() {
+        if (buf_ring != nullptr) { munmap(buf_ring, buf_ring_size); }
+        if (sqes != nullptr) { munmap(sqes, sqes_size); }
+        if ((cq_map != MAP_FAILED) && (cq_map != sq_map)) {
+            munmap(cq_map, cq_map_size);
+        }
+        if (sq_map != MAP_FAILED) { munmap(sq_map, sq_map_size); }
+        if (fd != -1) { close(fd); }
+    }
+
+    // Returns the next free SQE, or nullptr if the SQ is full
+    io_uring_sqe *get_sqe() {
+        const uint32_t tail = *sq_tail;
+        if ((tail - LOAD_ACQUIRE(sq_head)) >= sq_entries) {
+            return nullptr;
+        }
+        const uint32_t idx = (tail & *sq_mask);
+        io_uring_sqe *sqe = &(sqes[idx]);
+        memset(sqe, 0, sizeof(*sqe));
+
+        sq_array[idx] = idx;
+        STORE_RELEASE(sq_tail, tail + 1);
+        return sqe;
+    }
+};
+
+/**
+ * Helper functions.
+ */
+static int sys_io_uring_setup(unsigned entries, io_uring_params *p) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, p));
+}
+
+static int sys_io_uring_enter(int fd, unsigned to_submit,
+                              unsigned min_complete, unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd,
+        to_submit, min_complete, flags, nullptr, 0));
+}
+
+static int sys_io_uring_register(int fd, unsigned opcode,
+                                 void *arg, unsigned nr_args) {
+    return static_cast<int>(syscall(
+        __NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+// Clears (or restores) O_NONBLOCK. io_uring requires blocking FDs,
+// since it would otherwise surface EAGAIN to us instead of arming its
+// internal poll handler; socket I/O requires non-blocking ones.
+static bool set_blocking(const int fd, const bool blocking) {
+    const int flags = fcntl(fd, F_GETFL, 0);
+    return ((flags >= 0) && (fcntl(fd, F_SETFL, (blocking ?
+        (flags & ~O_NONBLOCK) : (flags | O_NONBLOCK))) >= 0));
+}
+
+uring_backend::uring_backend() : ring_(std::make_unique<ring>()) {}
+
+uring_backend::~uring_backend() {
+    // Outstanding receives and sends reference the provided buffers and
+    // queued packets, and closing the ring only cancels them lazily. If
+    // we can't reap every request, leak the memory rather than free it.
+    const bool is_quiesced = cancel_all();
+    ring_.reset();
+    if (!is_quiesced) { rx_buffers_.release(); }
+
+    for (auto& port : ports_) {
+        for (auto packet : port.rx_ready) { free(packet); }
+        if (is_quiesced) {
+            for (auto packet : port.tx_queue) { free(packet); }
+        }
+    }
+}
+
+bool uring_backend::setup(const std::vector<int>& rx_fds,
+                          const std::vector<int>& tx_fds) {
+    assert(rx_fds.size() == tx_fds.size());
+    ring& r = *ring_;
+
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_SUBMIT_ALL;
+    if ((r.fd = sys_io_uring_setup(RING_DEPTH, &params)) < 0) {
+        return false;
+    }
+    r.sq_entries = params.sq_entries;
+
+    // Map the SQ and CQ rings (a single mapping on newer kernels)
+    r.sq_map_size = (params.sq_off.array +
+                     (params.sq_entries * sizeof(uint32_t)));
+    r.cq_map_size = (params.cq_off.cqes +
+                     (params.cq_entries * sizeof(io_uring_cqe)));
+
+    const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP);
+    if (single_mmap) {
+        r.sq_map_size = std::max(r.sq_map_size, r.cq_map_size);
+        r.cq_map_size = r.sq_map_size;
+    }
+    r.sq_map = mmap(nullptr, r.sq_map_size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, r.fd, IORING_OFF_SQ_RING);
+    if (r.sq_map == MAP_FAILED) { return false; }
+
+    if (single_mmap) { r.cq_map = r.sq_map; }
+    else {
+        r.cq_map = mmap(nullptr, r.cq_map_size, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, r.fd, IORING_OFF_CQ_RING);
+        if (r.cq_map == MAP_FAILED) { return false; }
+    }
+    r.sqes_size = (params.sq_entries * sizeof(io_uring_sqe));
+    void *sqes = mmap(nullptr, r.sqes_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, r.fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) { return false; }
+    r.sqes = static_cast<io_uring_sqe*>(sqes);
+
+    char *sq = static_cast<char*>(r.sq_map);
+    r.sq_head = reinterpret_cast<uint32_t*>(sq + params.sq_off.head);
+    r.sq_tail = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+    r.sq_mask = reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+    r.sq_array = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+
+    char *cq = static_cast<char*>(r.cq_map);
+    r.cq_head = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+    r.cq_tail = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+    r.cq_mask = reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+    r.cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    // Register the provided buffer ring (page-aligned memory)
+    r.buf_ring_size = (NUM_RX_BUFFERS * sizeof(io_uring_buf));
+    void *buf_ring = mmap(nullptr, r.buf_ring_size, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buf_ring == MAP_FAILED) { return false; }
+    r.buf_ring = static_cast<io_uring_buf_ring*>(buf_ring);
+    // Fault the pages in before the kernel pins them (otherwise it
+    // may pin the shared zero page, and never see our updates).
+    memset(buf_ring, 0, r.buf_ring_size);
+
+    io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = reinterpret_cast<uint64_t>(r.buf_ring);
+    reg.ring_entries = NUM_RX_BUFFERS;
+    reg.bgid = RX_BUFFER_GROUP;
+    if (sys_io_uring_register(r.fd,
+        IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        return false;
+    }
+    rx_buffers_ = std::make_unique<char[]>(
+        NUM_RX_BUFFERS * RX_BUFFER_SIZE);
+
+    for (uint32_t bid = 0; bid < NUM_RX_BUFFERS; bid++) {
+        recycle_buffer(bid);
+    }
+    // Multishot receives postdate provided buffer rings, so check for
+    // them separately (before touching the neighbor FDs' flags).
+    if (!probe_multishot_recv()) { return false; }
+
+    // Initialize port state and make the FDs blocking
+    bool success = true;
+    ports_.resize(rx_fds.size());
+    for (uint16_t port = 0; success && (port < ports_.size()); port++) {
+        port_state& state = ports_[port];
+        state.rx_fd = rx_fds[port];
+        state.tx_fd = tx_fds[port];
+        state.rx_stream = std::make_unique<char[]>(
+            RX_BUFFER_SIZE + MAX_MIXNET_PACKET_SIZE);
+
+        success = (set_blocking(state.rx_fd, true) &&
+                   set_blocking(state.tx_fd, true));
+    }
+    // Arm the receive path
+    for (uint16_t port = 0; success && (port < ports_.size()); port++) {
+        arm_recv(port);
+        success = (ports_[port].rx_error == error_code::NONE);
+    }
+    if (success) { success = (submit(false) == error_code::NONE); }
+
+    // On failure, callers fall back to socket I/O, so quiesce the ring
+    // and restore the FDs' original (non-blocking) mode.
+    if (!success) {
+        cancel_all();
+        for (const auto& state : ports_) {
+            if (state.rx_fd != -1) { set_blocking(state.rx_fd, false); }
+            if (state.tx_fd != -1) { set_blocking(state.tx_fd, false); }
+        }
+    }
+    return success;
+}
+
+std::unique_ptr<uring_backend> uring_backend::create(
+    const std::vector<int>& rx_fds, const std::vector<int>& tx_fds) {
+    auto backend = std::make_unique<uring_backend>();
+    if (!backend->setup(rx_fds, tx_fds)) { backend.reset(); }
+    return backend;
+}
+
+void uring_backend::recycle_buffer(const uint16_t bid) {
+    ring& r = *ring_;
+    // Note: Index the ring as a plain array; in C++, the flexible
+    // array wrapper in the UAPI header shifts io_uring_buf_ring::bufs.
+    io_uring_buf *buf = (reinterpret_cast<io_uring_buf*>(r.buf_ring) +
+                         (r.buf_tail & (NUM_RX_BUFFERS - 1)));
+
+    buf->addr = reinterpret_cast<uint64_t>(
+        rx_buffers_.get() + (bid * RX_BUFFER_SIZE));
+    buf->len = RX_BUFFER_SIZE;
+    buf->bid = bid;
+
+    r.buf_tail++;
+    STORE_RELEASE(&(r.buf_ring->tail), r.buf_tail);
+}
+
+void uring_backend::arm_recv(const uint16_t port) {
+    io_uring_sqe *sqe = ring_->get_sqe();
+    if (sqe == nullptr) {
+        // SQ is full; flush it and retry once
+        auto error_code = submit(false);
+        if (error_code != error_code::NONE) {
+            ports_[port].rx_error = error_code;
+            return;
+        }
+        sqe = ring_->get_sqe();
+        if (sqe == nullptr) { return; } // Re-armed on next poll
+    }
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = ports_[port].rx_fd;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->buf_group = RX_BUFFER_GROUP;
+    sqe->user_data = ((TAG_RECV << 32) | port);
+
+    ports_[port].rx_armed = true;
+    num_unsubmitted_++;
+    num_inflight_++;
+}
+
+void uring_backend::issue_send(const uint16_t port) {
+    port_state& state = ports_[port];
+    assert(!state.tx_busy && !state.tx_queue.empty());
+
+    io_uring_sqe *sqe = ring_->get_sqe();
+    if (sqe == nullptr) {
+        auto error_code = submit(false);
+        if (error_code != error_code::NONE) {
+            tx_error_ = error_code;
+            return;
+        }
+        sqe = ring_->get_sqe();
+        if (sqe == nullptr) { return; } // Retried on next poll
+    }
+    const mixnet_packet *packet = state.tx_queue.front();
+    sqe->opcode = IORING_OP_SEND;
+    sqe->fd = state.tx_fd;
+    sqe->addr = reinterpret_cast<uint64_t>(
+        reinterpret_cast<const char*>(packet) + state.tx_offset);
+    sqe->len = (packet->total_size - state.tx_offset);
+    sqe->msg_flags = MSG_NOSIGNAL;
+    sqe->user_data = ((TAG_SEND << 32) | port);
+
+    state.tx_busy = true;
+    num_unsubmitted_++;
+    num_inflight_++;
+}
+
+error_code uring_backend::submit(const bool wait) {
+    if ((num_unsubmitted_ == 0) && !wait) { return error_code::NONE; }
+
+    int rc = -1;
+    do {
+        rc = sys_io_uring_enter(ring_->fd, num_unsubmitted_,
+            (wait ? 1 : 0), (wait ? IORING_ENTER_GETEVENTS : 0));
+    }
+    while ((rc < 0) && (errno == EINTR));
+    if (rc < 0) { return error_code::MIXNET_CONNECTION_BROKEN; }
+
+    num_unsubmitted_ -= std::min<uint32_t>(num_unsubmitted_, rc);
+    return error_code::NONE;
+}
+
+void uring_backend::complete_recv(const uint16_t port,
+    const int32_t res, const uint32_t flags) {
+    port_state& state = ports_[port];
+    if (!(flags & IORING_CQE_F_MORE)) { state.rx_armed = false; }
+
+    if (res <= 0) {
+        // Out of provided buffers, simply re-arm later
+        if (res == -ENOBUFS) { return; }
+        // Connection closed or broken
+        state.rx_error = error_code::MIXNET_CONNECTION_BROKEN;
+        return;
+    }
+    assert(flags & IORING_CQE_F_BUFFER);
+    const uint16_t bid = (flags >> IORING_CQE_BUFFER_SHIFT);
+    const char *chunk = rx_buffers_.get() + (bid * RX_BUFFER_SIZE);
+
+    // Append the chunk to the port's stream, then hand the
+    // provided buffer straight back to the kernel.
+    memcpy(state.rx_stream.get() + state.rx_length, chunk, res);
+    state.rx_length += res;
+    recycle_buffer(bid);
+
+    // Extract every complete (length-prefixed) packet
+    size_t offset = 0;
+    while ((state.rx_length - offset) >= sizeof(uint16_t)) {
+        uint16_t length = 0;
+        memcpy(&length, state.rx_stream.get() + offset, sizeof(length));
+        if ((length < MIN_MIXNET_PACKET_SIZE) ||
+            (length > MAX_MIXNET_PACKET_SIZE)) {
+            state.rx_error = error_code::MALFORMED_MESSAGE;
+            return;
+        }
+        if ((state.rx_length - offset) < length) { break; }
+
+        auto packet = static_cast<mixnet_packet*>(malloc(length));
+        memcpy(packet, state.rx_stream.get() + offset, length);
+        state.rx_ready.push_back(packet);
+        offset += length;
+    }
+    // Retain the trailing partial packet (if any)
+    state.rx_length -= offset;
+    memmove(state.rx_stream.get(),
+            state.rx_stream.get() + offset, state.rx_length);
+}
+
+void uring_backend::complete_send(const uint16_t port, const int32_t res) {
+    port_state& state = ports_[port];
+    state.tx_busy = false;
+
+    if (res < 0) {
+        if ((res == -EAGAIN) || (res == -EINTR)) { issue_send(port); }
+        else { tx_error_ = error_code::MIXNET_CONNECTION_BROKEN; }
+        return;
+    }
+    mixnet_packet *packet = state.tx_queue.front();
+    state.tx_offset += res;
+
+    // Finished sending this packet, move on to the next one
+    if (state.tx_offset == packet->total_size) {
+        state.tx_queue.pop_front();
+        state.tx_offset = 0;
+        num_tx_queued_--;
+        free(packet);
+    }
+    if (!state.tx_queue.empty()) { issue_send(port); }
+}
+
+void uring_backend::reap() {
+    ring& r = *ring_;
+    uint32_t head = *(r.cq_head);
+    const uint32_t tail = LOAD_ACQUIRE(r.cq_tail);
+
+    for (; head != tail; head++) {
+        const io_uring_cqe& cqe = r.cqes[head & *(r.cq_mask)];
+        const uint16_t port = (cqe.user_data & 0xFFFF);
+        const uint64_t tag = (cqe.user_data >> 32);
+
+        retire(cqe.user_data, cqe.flags);
+        if (tag == TAG_RECV) { complete_recv(port, cqe.res, cqe.flags); }
+        else if (tag == TAG_SEND) { complete_send(port, cqe.res); }
+    }
+    STORE_RELEASE(r.cq_head, head);
+}
+
+void uring_backend::retire(const uint64_t user_data, const uint32_t flags) {
+    const uint64_t tag = (user_data >> 32);
+    // Multishot receives remain armed as long as F_MORE is set
+    if ((tag == TAG_SEND) || (((tag == TAG_RECV) || (tag == TAG_PROBE)) &&
+                              !(flags & IORING_CQE_F_MORE))) {
+        assert(num_inflight_ > 0);
+        num_inflight_--;
+    }
+}
+
+bool uring_backend::wait_cqe(uint64_t& user_data,
+                             int32_t& res, uint32_t& flags) {
+    ring& r = *ring_;
+    const uint32_t head = *(r.cq_head);
+    while (head == LOAD_ACQUIRE(r.cq_tail)) {
+        if (submit(true) != error_code::NONE) { return false; }
+    }
+    const io_uring_cqe& cqe = r.cqes[head & *(r.cq_mask)];
+    user_data = cqe.user_data;
+    res = cqe.res;
+    flags = cqe.flags;
+    retire(cqe.user_data, cqe.flags);
+
+    STORE_RELEASE(r.cq_head, head + 1);
+    return true;
+}
+
+bool uring_backend::probe_multishot_recv() {
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) < 0) { return false; }
+
+    // Queue a byte first: a multishot receive then completes right away
+    // (with more to come), while a kernel that doesn't support it fails
+    // the request (EINVAL) or treats it as a one-shot receive.
+    const char byte = 0;
+    bool is_supported = false;
+    io_uring_sqe *sqe = nullptr;
+    if ((::send(fds[1], &byte, 1, MSG_NOSIGNAL) == 1) &&
+        ((sqe = ring_->get_sqe()) != nullptr)) {
+        sqe->opcode = IORING_OP_RECV;
+        sqe->fd = fds[0];
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->ioprio = IORING_RECV_MULTISHOT;
+        sqe->buf_group = RX_BUFFER_GROUP;
+        sqe->user_data = (TAG_PROBE << 32);
+        num_unsubmitted_++;
+        num_inflight_++;
+
+        uint64_t user_data = 0; uint32_t flags = 0; int32_t res = 0;
+        bool is_first = true;
+        while (wait_cqe(user_data, res, flags)) {
+            if ((user_data >> 32) != TAG_PROBE) { continue; }
+            if (flags & IORING_CQE_F_BUFFER) {
+                recycle_buffer(flags >> IORING_CQE_BUFFER_SHIFT);
+            }
+            if (is_first) {
+                is_supported = ((res == 1) && (flags & IORING_CQE_F_MORE));
+                is_first = false;
+            }
+            // Still armed, so terminate it (the next CQE is final)
+            if (!(flags & IORING_CQE_F_MORE)) { break; }
+            shutdown(fds[0], SHUT_RDWR);
+        }
+    }
+    close(fds[0]);
+    close(fds[1]);
+    return (is_supported && (num_inflight_ == 0));
+}
+
+bool uring_backend::cancel_all() {
+    if (ring_->fd == -1) { return true; }
+    // Flush unsubmitted SQEs, then cancel every outstanding request
+    if (submit(false) != error_code::NONE) { return false; }
+    if (num_inflight_ == 0) { return true; }
+
+    io_uring_sqe *sqe = ring_->get_sqe();
+    if (sqe == nullptr) { return false; }
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->cancel_flags = (IORING_ASYNC_CANCEL_ALL | IORING_ASYNC_CANCEL_ANY);
+    sqe->user_data = (TAG_CANCEL << 32);
+    num_unsubmitted_++;
+
+    uint64_t user_data = 0; uint32_t flags = 0; int32_t res = 0;
+    while (num_inflight_ != 0) {
+        if (!wait_cqe(user_data, res, flags)) { return false; }
+    }
+    return true;
+}
+
+error_code uring_backend::poll() {
+    reap();
+    // Re-arm any receives that the kernel terminated
+    for (uint16_t port = 0; port < ports_.size(); port++) {
+        port_state& state = ports_[port];
+        if (!state.rx_armed && (state.rx_error == error_code::NONE)) {
+            arm_recv(port);
+        }
+        if (!state.tx_busy && !state.tx_queue.empty()) {
+            issue_send(port);
+        }
+    }
+    if (tx_error_ != error_code::NONE) { return tx_error_; }
+    return submit(false);
+}
+
+error_code uring_backend::recv(const uint16_t port,
+                               mixnet_packet **const packet) {
+    port_state& state = ports_[port];
+    if (!state.rx_ready.empty()) {
+        *packet = state.rx_ready.front();
+        state.rx_ready.pop_front();
+        return error_code::NONE;
+    }
+    return ((state.rx_error != error_code::NONE) ?
+            state.rx_error : error_code::RECV_ZERO_PENDING);
+}
+
+void uring_backend::discard(const uint16_t port) {
+    port_state& state = ports_[port];
+    for (auto packet : state.rx_ready) { free(packet); }
+    state.rx_ready.clear();
+}
+
+error_code uring_backend::send(const uint16_t port,
+                               mixnet_packet *const packet) {
+    auto error_code = error_code::NONE;
+    // Apply backpressure if the kernel isn't keeping up
+    while ((num_tx_queued_ >= MAX_TX_QUEUE_DEPTH) &&
+           (tx_error_ == error_code::NONE)) {
+        error_code = submit(true);
+        if (error_code != error_code::NONE) { break; }
+        reap();
+    }
+    if (tx_error_ != error_code::NONE) { error_code = tx_error_; }
+    if (error_code != error_code::NONE) { free(packet); return error_code; }
+
+    port_state& state = ports_[port];
+    state.tx_queue.push_back(packet);
+    num_tx_queued_++;
+
+    if (!state.tx_busy) { issue_send(port); }
+    return error_code::NONE;
+}
+
+// Cleanup
+#undef STORE_RELEASE
+#undef LOAD_ACQUIRE
+
+#else // MIXNET_IO_URING
+
+/**
+ * io_uring support was not compiled in. create() always fails, so
+ * callers fall back to regular socket I/O; the remaining methods
+ * are unreachable.
+ */
+struct uring_backend::ring {};
+
+uring_backend::uring_backend() {}
+uring_backend::~uring_backend() {}
+
+std::unique_ptr<uring_backend> uring_backend::create(
+    const std::vector<int>&, const std::vector<int>&) { return nullptr; }
+
+error_code uring_backend::poll() { return error_code::FRAGMENT_EXCEPTION; }
+void uring_backend::discard(const uint16_t) {}
+
+error_code uring_backend::recv(const uint16_t, mixnet_packet **const) {
+    return error_code::FRAGMENT_EXCEPTION;
+}
+error_code uring_backend::send(const uint16_t, mixnet_packet *const p) {
+    free(p); return error_code::FRAGMENT_EXCEPTION;
+}
+
+#endif // MIXNET_IO_URING
+
+} // namespace framework
@@ -0,0 +1,140 @@
+/**
+ * Copyright (C) 2023 Carnegie Mellon University
+ *
+ * This file is part of the Mixnet course project developed for
+ * the Computer Networks course (15-441/641) taught at Carnegie
+ * Mellon University.
+ *
+ * No part of the Mixnet project may be copied and/or distributed
+ * without the express permission of the 15-441/641 course staff.
+ */
+#ifndef FRAMEWORK_URING_BACKEND_H_
+#define FRAMEWORK_URING_BACKEND_H_
+
+#include "error.h"
+#include "mixnet/packet.h"
+
+#include <deque>
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+namespace framework {
+
+// Helper macros
+#define DISALLOW_COPY_AND_ASSIGN(TypeName)                  \
+    TypeName(const TypeName&) = delete;                     \
+    void operator=(const TypeName&) = delete
+
+/**
+ * io_uring-based link I/O for a node's neighbor ports.
+ *
+ * RX uses one multishot receive per port, drawing from a shared ring
+ * of provided buffers; received byte chunks are reassembled into the
+ * length-prefixed packet stream and parked in per-port ready queues.
+ * TX queues sends per port (at most one in flight, to preserve stream
+ * ordering) and batches their submission until the next poll(). Once
+ * set up, a busy node only enters the kernel to submit pending sends.
+ *
+ * All methods must be invoked from a single thread (the node thread),
+ * except for the constructor/destructor.
+ */
+class uring_backend final {
+public:
+    // Constant parameters
+    static constexpr uint32_t RING_DEPTH = 512;
+    static constexpr uint32_t NUM_RX_BUFFERS = 256;
+    static constexpr uint32_t RX_BUFFER_SIZE = MAX_MIXNET_PACKET_SIZE;
+    static constexpr size_t MAX_TX_QUEUE_DEPTH = 1024;
+
+private:
+    // Per-port state
+    struct port_state {
+        int rx_fd = -1;                                 // FD to receive on
+        int tx_fd = -1;                                 // FD to send on
+        bool rx_armed = false;                          // Multishot recv armed?
+        error_code rx_error = error_code::NONE;         // Latched RX error
+        size_t rx_length = 0;                           // Bytes in reassembly buffer
+        std::unique_ptr<char[]> rx_stream{};            // Reassembly buffer
+        std::deque<mixnet_packet*> rx_ready;            // Reassembled packets
+        bool tx_busy = false;                           // Send in flight?
+        uint16_t tx_offset = 0;                         // Bytes sent of queue head
+        std::deque<mixnet_packet*> tx_queue;            // Pending sends
+    };
+    // Ring state (opaque, see uring_backend.cpp)
+    struct ring;
+
+    std::unique_ptr<ring> ring_{};                      // Kernel ring mappings
+    std::vector<port_state> ports_;                     // Port ID -> State
+    std::unique_ptr<char[]> rx_buffers_{};              // Provided buffer memory
+    uint32_t num_unsubmitted_ = 0;                      // SQEs not yet submitted
+    uint32_t num_inflight_ = 0;                         // Requests the kernel may
+                                                        // still complete
+    size_t num_tx_queued_ = 0;                          // Packets queued for TX
+    error_code tx_error_ = error_code::NONE;            // Latched TX error
+
+    /**
+     * Internal helper methods.
+     */
+    bool setup(const std::vector<int>& rx_fds,
+               const std::vector<int>& tx_fds);
+
+    void reap();
+    void retire(const uint64_t user_data, const uint32_t flags);
+    bool wait_cqe(uint64_t& user_data, int32_t& res, uint32_t& flags);
+    bool probe_multishot_recv();
+    bool cancel_all();
+    void arm_recv(const uint16_t port);
+    void issue_send(const uint16_t port);
+    void recycle_buffer(const uint16_t buffer_id);
+    void complete_recv(const uint16_t port, const int32_t res,
+                       const uint32_t flags);
+    void complete_send(const uint16_t port, const int32_t res);
+    error_code submit(const bool wait);
+
+public:
+    ~uring_backend();
+    DISALLOW_COPY_AND_ASSIGN(uring_backend);
+    explicit uring_backend();
+
+    /**
+     * Creates a backend for the given neighbor FDs. Returns nullptr if
+     * io_uring support was not compiled in, or if the kernel does not
+     * provide the required features; callers should then fall back to
+     * regular socket I/O.
+     */
+    static std::unique_ptr<uring_backend> create(
+        const std::vector<int>& rx_fds, const std::vector<int>& tx_fds);
+
+    /**
+     * Submits batched sends and reaps completions. Returns any error
+     * latched on the TX path (which is then fatal for the node).
+     */
+    error_code poll();
+
+    /**
+     * Pops the next reassembled packet for the given port, if any.
+     * Returns RECV_ZERO_PENDING if none is available, or the error
+     * latched for this port's connection.
+     */
+    error_code recv(const uint16_t port, mixnet_packet **const packet);
+
+    /**
+     * Discards every packet received on the given port so far (used
+     * while the corresponding link is disabled).
+     */
+    void discard(const uint16_t port);
+
+    /**
+     * Queues a packet for transmission on the given port, taking
+     * ownership of it. Blocks only if the TX backlog is full.
+     */
+    error_code send(const uint16_t port, mixnet_packet *const packet);
+};
+
+// Cleanup
+#undef DISALLOW_COPY_AND_ASSIGN
+
+} // namespace framework
+
+#endif // FRAMEWORK_URING_BACKEND_H_
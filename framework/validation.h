@@ -0,0 +1,146 @@
+/**
+ * Copyright (C) 2023 Carnegie Mellon University
+ *
+ * This file is part of the Mixnet course project developed for
+ * the Computer Networks course (15-441/641) taught at Carnegie
+ * Mellon University.
+ *
+ * No part of the Mixnet project may be copied and/or distributed
+ * without the express permission of the 15-441/641 course staff.
+ */
+#ifndef FRAMEWORK_VALIDATION_H_
+#define FRAMEWORK_VALIDATION_H_
+
+#include "mixnet/address.h"
+#include "mixnet/packet.h"
+
+#include <array>
+#include <cstddef>
+#include <stdint.h>
+#include <string.h>
+
+namespace framework {
+namespace validation {
+
+/**
+ * Per-type packet size specification. For a given packet type, the
+ * expected payload size is (base + (stride * count)), where count is
+ * the 16-bit field located at count_offset within the payload (only
+ * consulted if stride is non-zero). Types with a free-form payload
+ * (e.g., DATA) specify a lower bound instead of an exact size.
+ */
+struct size_spec {
+    bool is_known;                      // Recognized packet type?
+    bool is_user_type;                  // Permitted on the user port?
+    bool is_exact;                      // Exact size (else lower bound)
+    uint16_t base;                      // Fixed payload size (in bytes)
+    uint16_t stride;                    // Size of each variable element
+    uint16_t count_offset;              // Payload offset of element count
+};
+
+// Sentinel entry for unknown packet types
+static constexpr size_spec UNKNOWN_SPEC{false, false, true, 0, 0, 0};
+
+/**
+ * Returns the size specification for the given (known) packet type,
+ * derived directly from the struct definitions in mixnet/packet.h.
+ */
+constexpr size_spec make_spec(const mixnet_packet_type_t type) {
+    switch (type) {
+    case PACKET_TYPE_STP: {
+        return {true, false, true,
+                sizeof(mixnet_packet_stp), 0, 0};
+    }
+    case PACKET_TYPE_FLOOD: {
+        return {true, true, true, 0, 0, 0};
+    }
+    case PACKET_TYPE_LSA: {
+        return {true, false, true,
+                sizeof(mixnet_packet_lsa),
+                sizeof(mixnet_lsa_link_params),
+                offsetof(mixnet_packet_lsa, neighbor_count)};
+    }
+    case PACKET_TYPE_DATA: {
+        return {true, true, false, 0, 0, 0};
+    }
+    case PACKET_TYPE_PING: {
+        return {true, true, true,
+                (sizeof(mixnet_packet_ping) +
+                 sizeof(mixnet_packet_routing_header)),
+                sizeof(mixnet_address),
+                offsetof(mixnet_packet_routing_header, route_length)};
+    }
+    default: { return UNKNOWN_SPEC; }
+    } // switch
+}
+
+// Validator table, indexed by packet type. The last entry is
+// the sentinel used for every out-of-range type value.
+static constexpr size_t NUM_PACKET_TYPES = (PACKET_TYPE_PING + 1);
+typedef std::array<size_spec, NUM_PACKET_TYPES + 1> spec_table;
+
+constexpr spec_table make_spec_table() {
+    spec_table table{};
+    for (size_t type = 0; type < NUM_PACKET_TYPES; type++) {
+        table[type] = make_spec(static_cast<mixnet_packet_type_t>(type));
+    }
+    table[NUM_PACKET_TYPES] = UNKNOWN_SPEC;
+    return table;
+}
+static constexpr spec_table SPEC_TABLE = make_spec_table();
+
+// Sanity checks: Ensure the table reflects the packet layouts
+static_assert(SPEC_TABLE[PACKET_TYPE_STP].base == 6, "Bad STP spec");
+static_assert(SPEC_TABLE[PACKET_TYPE_LSA].count_offset == 2, "Bad LSA spec");
+static_assert(SPEC_TABLE[PACKET_TYPE_PING].count_offset == 4, "Bad PING spec");
+static_assert(!SPEC_TABLE[NUM_PACKET_TYPES].is_known, "Bad sentinel spec");
+
+/**
+ * Returns the table entry for a packet type (never out-of-bounds).
+ */
+inline const size_spec& lookup(const mixnet_packet_type_t type) {
+    return SPEC_TABLE[(type < NUM_PACKET_TYPES) ?
+                      type : NUM_PACKET_TYPES];
+}
+
+/**
+ * Validates a packet's total size against its type specification.
+ * The element count is only read if it lies within the payload, so
+ * this never touches memory beyond packet->total_size.
+ */
+inline bool validate(const mixnet_packet *const packet) {
+    const uint16_t total_size = packet->total_size;
+    if ((total_size < MIN_MIXNET_PACKET_SIZE) ||
+        (total_size > MAX_MIXNET_PACKET_SIZE)) {
+        return false;
+    }
+    const size_spec& spec = lookup(packet->type);
+    const uint32_t payload_size = (total_size - sizeof(mixnet_packet));
+
+    uint16_t count = 0;
+    const bool has_count = (payload_size >= (
+        spec.count_offset + sizeof(count)));
+
+    if (has_count) {
+        memcpy(&count, packet->payload() +
+               spec.count_offset, sizeof(count));
+    }
+    const uint32_t expected = (spec.base + (
+        static_cast<uint32_t>(spec.stride) * count));
+
+    return (spec.is_known && (spec.is_exact ?
+            (payload_size == expected) :
+            (payload_size >= expected)));
+}
+
+/**
+ * Validates a packet delivered on (or injected into) the user port.
+ */
+inline bool validate_user(const mixnet_packet *const packet) {
+    return (lookup(packet->type).is_user_type && validate(packet));
+}
+
+} // namespace validation
+} // namespace framework
+
+#endif // FRAMEWORK_VALIDATION_H_
@@ -53,7 +53,9 @@ extern "C" {
  *               (a) free()'d once you are done processing them, OR
  *               (b) sent back over the network using mixnet_send()
  *
- * @return Number of packets received
+ * @return Number of packets received, or -1 on error (e.g., if the node
+ *         has more ports than an 8-bit port ID can address; in that case,
+ *         use mixnet_recv_wide() instead)
  */
 int mixnet_recv(void *handle, uint8_t *port, mixnet_packet **packet);
 
@@ -81,6 +83,51 @@ int mixnet_recv(void *handle, uint8_t *port, mixnet_packet **packet);
  */
 int mixnet_send(void *handle, const uint8_t port, mixnet_packet *packet);
 
+/**
+ * Wide-port variants of mixnet_recv() and mixnet_send(). Semantics are
+ * identical, but port IDs span the full range of num_neighbors (which
+ * is a uint16_t), so these work for nodes with more than 255 neighbors
+ * (where the n'th, i.e. user, port no longer fits in a uint8_t).
+ */
+int mixnet_recv_wide(void *handle, uint16_t *port, mixnet_packet **packet);
+int mixnet_send_wide(void *handle, const uint16_t port, mixnet_packet *packet);
+
+/**
+ * Report this node's control-plane state to the framework, which uses
+ * it to detect when the network has converged (so that testcases need
+ * not wait for the worst-case convergence time). Reporting is optional
+ * but, if used, should be done whenever the state may have changed
+ * (e.g., once per iteration of the main loop); reports that repeat the
+ * previous state are cheap, and are ignored.
+ *
+ * @param handle Opaque handle. DO NOT TOUCH!
+ * @param root_address Address of the node this node believes is the root
+ * @param path_length Length (in hops) of this node's path to the root
+ * @param next_hop Address of this node's next hop towards the root
+ * @param lsdb_size Number of nodes in this node's link-state database
+ *                  (including this node itself)
+ */
+void mixnet_report_state(void *handle, const mixnet_address root_address,
+                         const uint16_t path_length,
+                         const mixnet_address next_hop,
+                         const uint16_t lsdb_size);
+
+/**
+ * Report this node's cumulative control-plane counters to the framework,
+ * which benchmarks use to measure control-plane overhead. Like state
+ * reports, these are optional and cheap, so they can be made once per
+ * iteration of the main loop.
+ *
+ * @param handle Opaque handle. DO NOT TOUCH!
+ * @param stp_packets_sent Number of STP packets this node has sent
+ * @param lsa_packets_sent Number of LSA packets this node has sent
+ *                         (including ones it forwarded)
+ * @param spf_runs Number of times this node has (re)computed its paths
+ */
+void mixnet_report_counters(void *handle, const uint64_t stp_packets_sent,
+                            const uint64_t lsa_packets_sent,
+                            const uint64_t spf_runs);
+
 #ifdef __cplusplus
 }
 #endif
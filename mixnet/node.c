@@ -74,6 +74,21 @@ typedef struct {
 } mixing_packet_held;
 
 
+// Mixnet address -> port lookup. Addresses are 16 bits wide, so a
+// direct-indexed table resolves a neighbor's port in O(1), however
+// many neighbors the node has.
+#define NO_PORT ((uint16_t)-1)
+#define PORT_TABLE_SIZE (1 << 16)
+
+uint16_t *port_table_create(void) {
+    uint16_t *table = (uint16_t*)malloc(sizeof(uint16_t) * PORT_TABLE_SIZE);
+    if (table != NULL) {
+        memset(table, 0xFF, sizeof(uint16_t) * PORT_TABLE_SIZE); // NO_PORT
+    }
+    return table;
+}
+
+
 bool pq_empty(pq_entry *pq) {
     return (pq == NULL);
 }
@@ -181,7 +196,7 @@ bool node_compare(mixnet_packet_stp* payload, stp_info info) {
 }
 
 
-int forward_packet(void *const handle, uint8_t port_n, mixnet_packet *packet) {
+int forward_packet(void *const handle, uint16_t port_n, mixnet_packet *packet) {
     // // printf("forwarding packet\n");
     mixnet_packet *new_packet = (mixnet_packet*)malloc(packet->total_size);
     if (new_packet == NULL) {
@@ -190,7 +205,7 @@ int forward_packet(void *const handle, uint8_t port_n, mixnet_packet *packet) {
     }
     memcpy(new_packet, packet, packet->total_size);
     // // printf("forwarded packet\n");
-    return mixnet_send(handle, port_n, new_packet);
+    return mixnet_send_wide(handle, port_n, new_packet);
 }
 
 
@@ -211,7 +226,7 @@ int send_stp(void *const handle, const struct mixnet_node_config c, stp_info my_
         stp_payload->path_length = my_info.path_len;
         stp_payload->node_address = c.node_addr;
         
-        fail = mixnet_send(handle, i, to_send_packet);
+        fail = mixnet_send_wide(handle, i, to_send_packet);
         (*stp_packet_counter)++; // Increment the counter for each STP packet sent
         if (fail == -1) {
             return -1;
@@ -311,6 +326,12 @@ void add_to_global_view(global_view **p,
     *p = new_node;
 }
 
+uint16_t global_view_size(global_view *p) {
+    uint16_t size = 0;
+    for (; p != NULL; p = p->next) { size++; }
+    return size;
+}
+
 void compute_shortest_paths(global_view *p, mixnet_address src_addr) {
     //printf("%d computing shortest paths\n", src_addr);
     //print_in_global_view_list(p, src_addr);
@@ -554,6 +575,8 @@ void run_node(void *const handle,
     int reelection_interval = c.reelection_interval_ms;
 
     uint64_t stp_packets_sent = 0;
+    uint64_t lsa_packets_sent = 0;
+    uint64_t spf_runs = 0;
     uint64_t last_stp_update_time = time_now();
     bool stp_converged = false;
 
@@ -597,11 +620,16 @@ void run_node(void *const handle,
     uint64_t start_time = time_now();
     uint64_t last_root_message_time = time_now();
     bool lsa_done = false;
+    uint16_t lsdb_size = 1; // Just this node, for now
 
     // printf("running node: %d\n", c.node_addr);
     // printf("num neigbors: %d\n", c.num_neighbors);
     stp_info my_info = {c.node_addr, c.node_addr, 0};
     neighbor_state_t *neighbor_info = (neighbor_state_t*)calloc(c.num_neighbors, sizeof(neighbor_state_t));
+    uint16_t *port_table = port_table_create();
+    if (port_table == NULL) {
+        return;
+    }
     
 
 
@@ -619,7 +647,7 @@ void run_node(void *const handle,
         stp->root_address = c.node_addr;
         stp->path_length= 0;
         stp->node_address= c.node_addr;
-        mixnet_send(handle, i, to_send_packet);
+        mixnet_send_wide(handle, i, to_send_packet);
         stp_packets_sent++; // Count initial STP packets
         // // printf("stp packet sent\n");
     }
@@ -647,11 +675,8 @@ void run_node(void *const handle,
             
             // Block the old path to root
             if (old_next_hop != c.node_addr) {
-                for (int i = 0; i < c.num_neighbors; i++) {
-                    if (neighbor_info[i].neighbor_addr == old_next_hop) {
-                        neighbor_info[i].blocked = true;
-                    }
-                }
+                uint16_t old_port = port_table[old_next_hop];
+                if (old_port != NO_PORT) { neighbor_info[old_port].blocked = true; }
             }
             
             // Broadcast our new root claim
@@ -679,7 +704,7 @@ void run_node(void *const handle,
         //// // // printf("before lsa broadcast\n");
         if (current_time - start_time >= 100 && !lsa_done) {
         // // printf("%d start lsa broadcast\n", c.node_addr);
-            for (uint8_t port_n = 0; port_n < c.num_neighbors; port_n++) {
+            for (uint16_t port_n = 0; port_n < c.num_neighbors; port_n++) {
                 if (!neighbor_info[port_n].blocked) {
                     //send LSA packet
                     //mixnet_packet *to_send_packet = (mixnet_packet*)malloc(sizeof(mixnet_packet) + sizeof(mixnet_packet_stp));
@@ -707,7 +732,8 @@ void run_node(void *const handle,
                     //     printf("%d ", lsa_payload->links[i].neighbor_mixaddr);
                     // }
                     // printf("]\n");
-                    mixnet_send(handle, port_n, to_send_packet);
+                    mixnet_send_wide(handle, port_n, to_send_packet);
+                    lsa_packets_sent++;
                 }
             }
             lsa_done = true;
@@ -719,15 +745,21 @@ void run_node(void *const handle,
             return;
         }
 
+        // Let the framework know where we stand (for convergence detection)
+        mixnet_report_state(handle, my_info.root_addr, my_info.path_len,
+                            my_info.next_hop, lsdb_size);
+        mixnet_report_counters(handle, stp_packets_sent,
+                               lsa_packets_sent, spf_runs);
+
         mixnet_packet *packet;
-        uint8_t port = 0;
+        uint16_t port = 0;
         // packet received
-        if (mixnet_recv(handle, &port, &packet) == 1) {
+        if (mixnet_recv_wide(handle, &port, &packet) == 1) {
             if (port == c.num_neighbors){ // source node
                 //// // printf("user sent flood packet. sending flood out as source node\n");
                 if (packet->type == 1) { // PACKET TYPE FLOOD
                     // // // printf("packet type is actually flood\n");
-                    for (uint8_t port_n = 0; port_n <c.num_neighbors; port_n++) {
+                    for (uint16_t port_n = 0; port_n <c.num_neighbors; port_n++) {
                         if (!neighbor_info[port_n].blocked) {
                             forward_packet(handle, port_n, packet);
                         }
@@ -737,7 +769,7 @@ void run_node(void *const handle,
                     }
                 } else { // PACKET TYPE PING OR DATA received from the user
                     mixnet_packet* new_packet = NULL;
-                    uint16_t forward_to = (uint16_t)-1;
+                    uint16_t forward_to = NO_PORT;
 
                     if (packet->type == PACKET_TYPE_DATA) {
                         mixnet_packet_routing_header* payload = (mixnet_packet_routing_header*)(packet->payload);
@@ -754,12 +786,7 @@ void run_node(void *const handle,
                                 new_packet = create_forwarding_packet(packet, destination_node->path, destination_node->path_size);
                             }
                             mixnet_address first_hop_addr = destination_node->first_hop_addr;
-                            for (int i = 0; i < c.num_neighbors; i++) {
-                                if (neighbor_info[i].neighbor_addr == first_hop_addr) {
-                                    forward_to = i;
-                                    break;
-                                }
-                            }
+                            forward_to = port_table[first_hop_addr];
                         }
                     } else { // PACKET TYPE PING
                         mixnet_packet_routing_header* payload = (mixnet_packet_routing_header*)(packet->payload);
@@ -770,16 +797,11 @@ void run_node(void *const handle,
                             new_packet = create_forwarding_packet(packet, destination_node->path, destination_node->path_size);
                             
                             mixnet_address first_hop_addr = destination_node->first_hop_addr;
-                            for (int i = 0; i < c.num_neighbors; i++) {
-                                if (neighbor_info[i].neighbor_addr == first_hop_addr) {
-                                    forward_to = i;
-                                    break;
-                                }
-                            }
+                            forward_to = port_table[first_hop_addr];
                         }
                     }
 
-                    if (new_packet != NULL && forward_to != (uint16_t)-1) {
+                    if (new_packet != NULL && forward_to != NO_PORT) {
                         // Inside the user port block, after creating the PING packet
                         // if (new_packet->type == PACKET_TYPE_PING) {
                         //     // mixnet_packet_routing_header* rh = (mixnet_packet_routing_header*)(new_packet->payload);
@@ -795,7 +817,7 @@ void run_node(void *const handle,
 
                         if (packet_counter >= c.mixing_factor) {
                             for (uint16_t i = 0; i < packet_counter; i++) {
-                                mixnet_send(handle, mix_packets[i].port, mix_packets[i].packet);
+                                mixnet_send_wide(handle, mix_packets[i].port, mix_packets[i].packet);
                             }
                             packet_counter = 0;
                         }
@@ -804,6 +826,10 @@ void run_node(void *const handle,
             } else {
                 if (packet->type == PACKET_TYPE_STP) {
                     mixnet_packet_stp* payload = (mixnet_packet_stp*)(packet->payload);
+                    if (port_table[neighbor_info[port].neighbor_addr] == port) {
+                        port_table[neighbor_info[port].neighbor_addr] = NO_PORT;
+                    }
+                    port_table[payload->node_address] = port;
                     neighbor_info[port].neighbor_addr = payload->node_address;
                     neighbhor_costs[port].neighbor_mixaddr = payload->node_address;
                     //// // printf("received stp packet from %d claiming %d is the root with path len %d\n", payload->node_address, payload->root_address, payload->path_length);
@@ -840,11 +866,8 @@ void run_node(void *const handle,
 
 
                         if (old_next_hop != c.node_addr) {
-                            for (int i = 0; i < c.num_neighbors; i++) {
-                                if (neighbor_info[i].neighbor_addr == old_next_hop) {
-                                    neighbor_info[i].blocked = true;
-                                }
-                            }
+                            uint16_t old_port = port_table[old_next_hop];
+                            if (old_port != NO_PORT) { neighbor_info[old_port].blocked = true; }
                         }
 
 
@@ -878,9 +901,10 @@ void run_node(void *const handle,
                         temp_lsa_counter++;
                         mixnet_packet_lsa* payload = (mixnet_packet_lsa*)(packet->payload);
                         add_to_global_view(&adj_list_start, payload->node_address, payload->links, payload->neighbor_count);
+                        lsdb_size = global_view_size(adj_list_start);
                         
                         // Forward this LSA to other neighbors
-                        for (uint8_t port_n = 0; port_n < c.num_neighbors; port_n++) {
+                        for (uint16_t port_n = 0; port_n < c.num_neighbors; port_n++) {
                             if (!neighbor_info[port_n].blocked && port_n != port) {
                                 int packet_size = sizeof(mixnet_packet) + (4 + (4 * payload->neighbor_count));
                                 
@@ -890,10 +914,12 @@ void run_node(void *const handle,
                                 memcpy(to_send_packet, packet, packet_size);
                                 to_send_packet->total_size = packet_size;
                                 
-                                mixnet_send(handle, port_n, to_send_packet);
+                                mixnet_send_wide(handle, port_n, to_send_packet);
+                                lsa_packets_sent++;
                             }
                         }
                         compute_shortest_paths(adj_list_start, c.node_addr);
+                        spf_runs++;
                         // global_view* curr = adj_list_start;
                         // while (curr != NULL) {
                         //     printf("Node %d: Path to %d: ", c.node_addr, curr->node_addr);
@@ -908,7 +934,7 @@ void run_node(void *const handle,
                     }
                 } else if (packet->type == PACKET_TYPE_FLOOD) {
                     if (!neighbor_info[port].blocked) {
-                        for (uint8_t port_n = 0; port_n <= c.num_neighbors; port_n++) {
+                        for (uint16_t port_n = 0; port_n <= c.num_neighbors; port_n++) {
                             if (port_n < c.num_neighbors && !neighbor_info[port_n].blocked && port_n != port) {
                                 // Forward to unblocked neighbors
                                 forward_packet(handle, port_n, packet);
@@ -929,7 +955,7 @@ void run_node(void *const handle,
                             // printf("[Node %d] receiving ping from %d. is_request: %d. hop_index: %d\n", c.node_addr, payload->src_address, ping_payload->is_request, payload->hop_index);
                             // printf("forwarding to user\n");
                             forward_packet(handle, c.num_neighbors, packet);
-                            //mixnet_send(handle, c.num_neighbors, packet);
+                            //mixnet_send_wide(handle, c.num_neighbors, packet);
 
                             if (ping_payload->is_request) {
                                 for(int i = 0; i < payload->route_length / 2; i++) {
@@ -945,22 +971,17 @@ void run_node(void *const handle,
                                 
                                 mixnet_address next_hop_addr = (payload->route_length > 0) ? payload->route[0] : payload->dst_address;
 
-                                uint16_t forward_to = (uint16_t)-1;
-                                for (int i = 0; i < c.num_neighbors; i++) {
-                                    if (neighbor_info[i].neighbor_addr == next_hop_addr) {
-                                        forward_to = i;
-                                        break;
-                                    }
-                                }
-                                if (forward_to != (uint16_t)-1) {
-                                    mixnet_send(handle, forward_to, packet);
+                                uint16_t forward_to = NO_PORT;
+                                forward_to = port_table[next_hop_addr];
+                                if (forward_to != NO_PORT) {
+                                    mixnet_send_wide(handle, forward_to, packet);
                                 }
                             } else {
                                 uint64_t rtt = time_now() - ping_payload->send_time;
                                 printf("RTT %d:%d is %lu\n", payload->src_address, payload->dst_address, rtt);
                             }
                             //forward_packet(handle, c.num_neighbors, packet);
-                            //mixnet_send(handle, c.num_neighbors, packet);
+                            //mixnet_send_wide(handle, c.num_neighbors, packet);
                         } else { // It's a DATA packet for me, send to user
                             //printf("forwarding to user\n");
                             forward_packet(handle, c.num_neighbors, packet);
@@ -977,15 +998,10 @@ void run_node(void *const handle,
                             next_hop_addr = received_rh->dst_address;
                         }
 
-                        uint16_t forward_to = (uint16_t)-1;
-                        for (int i = 0; i < c.num_neighbors; i++) {
-                            if (neighbor_info[i].neighbor_addr == next_hop_addr) {
-                                forward_to = i;
-                                break;
-                            }
-                        }
+                        uint16_t forward_to = NO_PORT;
+                        forward_to = port_table[next_hop_addr];
 
-                        if (forward_to != (uint16_t)-1) {
+                        if (forward_to != NO_PORT) {
                             mixnet_packet* packet_to_send = (mixnet_packet*)malloc(packet->total_size);
                             memcpy(packet_to_send, packet, packet->total_size);
                             mixnet_packet_routing_header* outgoing_rh = (mixnet_packet_routing_header*)(packet_to_send->payload);
@@ -997,7 +1013,7 @@ void run_node(void *const handle,
 
                             if (packet_counter >= c.mixing_factor) {
                                 for (uint16_t i = 0; i < packet_counter; i++) {
-                                    mixnet_send(handle, mix_packets[i].port, mix_packets[i].packet);
+                                    mixnet_send_wide(handle, mix_packets[i].port, mix_packets[i].packet);
                                 }
                                 packet_counter = 0;
                             }
@@ -1009,5 +1025,6 @@ void run_node(void *const handle,
         }
     }
     //// // printf("Node %d thinks %d is root\n", c.node_addr, my_info.root_addr);
+    free(port_table);
     // free(neighbor_info);
 }
\ No newline at end of file
@@ -12,7 +12,14 @@
 
 #include <algorithm>
 #include <assert.h>
+#include <cmath>
+#include <fstream>
+#include <iostream>
 #include <numeric>
+#include <random>
+#include <set>
+#include <sstream>
+#include <utility>
 
 namespace testing {
 
@@ -56,46 +63,364 @@ void graph::set_mixaddrs(const std::vector<mixnet_address>& m) {
     }
 }
 
+/**
+ * Disjoint-set forest over generator positions, used to track (and
+ * bridge) the connected components of randomly-generated topologies.
+ */
+class disjoint_sets final {
+private:
+    std::vector<uint16_t> parents_;
+
+public:
+    explicit disjoint_sets(const uint16_t n) : parents_(n) {
+        std::iota(parents_.begin(), parents_.end(), 0);
+    }
+    uint16_t find(uint16_t v) {
+        while (parents_[v] != v) {
+            v = parents_[v] = parents_[parents_[v]]; // Path halving
+        }
+        return v;
+    }
+    void join(const uint16_t u, const uint16_t v) { parents_[find(u)] = find(v); }
+};
+
+void graph::generate_topology(const type t,
+                std::vector<uint16_t> idxs) {
+    generate_topology(t, generator_params(), std::move(idxs));
+}
+
 void graph::generate_topology(const type t,
+                const generator_params& params,
                 std::vector<uint16_t> idxs) {
     if (num_nodes < 2) { return; }
     if (idxs.empty()) { idxs.resize(num_nodes);
                         std::iota(idxs.begin(), idxs.end(), 0); }
+
+    assert(params.min_cost <= params.max_cost); // Sanity check
+    const uint16_t n = idxs.size();
+    std::mt19937 rng(params.seed);
+    disjoint_sets components(n);
+
+    // Connects the vertices at positions (i, j) in the idx set. For
+    // DISTANCE-distributed costs, d is the edge's normalized length.
+    auto connect = [&] (const uint16_t i, const uint16_t j, const double d) {
+        std::uniform_int_distribution<uint16_t> cost_dist(
+            params.min_cost, params.max_cost);
+
+        uint16_t cost_ij = cost_dist(rng), cost_ji = cost_ij;
+        if (params.costs == cost_distribution::DISTANCE) {
+            cost_ij = cost_ji = static_cast<uint16_t>(std::lround(
+                params.min_cost + ((params.max_cost - params.min_cost) * d)));
+        }
+        else if (!params.symmetric_costs) { cost_ji = cost_dist(rng); }
+
+        add_edge(half_edge(idxs[i], cost_ij), half_edge(idxs[j], cost_ji));
+        components.join(i, j);
+    };
+    // Vertex coordinates (WAXMAN only), and the largest distance between them
+    std::vector<std::pair<double, double>> coordinates;
+    double max_distance = 0;
+    auto distance = [&] (const uint16_t i, const uint16_t j) {
+        return std::hypot(coordinates[i].first - coordinates[j].first,
+                          coordinates[i].second - coordinates[j].second);
+    };
+
     switch (t) {
     // Line topology
     case type::LINE: {
-        for (uint16_t i = 0; i < (idxs.size() - 1); i++) {
-            add_edge(idxs[i], idxs[i + 1]);
+        for (uint16_t i = 0; i < (n - 1); i++) {
+            connect(i, (i + 1), 0);
         }
     } break;
 
     // Ring topology
     case type::RING: {
-        assert(idxs.size() > 2); // Too few vertices
-        for (uint16_t i = 0; i < idxs.size(); i++) {
-            add_edge(idxs[i], idxs[(i + 1) % idxs.size()]);
+        assert(n > 2); // Too few vertices
+        for (uint16_t i = 0; i < n; i++) {
+            connect(i, ((i + 1) % n), 0);
         }
     } break;
 
     // Full mesh topology
     case type::FULL_MESH: {
-        for (uint16_t i = 0; i < idxs.size(); i++) {
-            for (uint16_t j = (i + 1); j < idxs.size(); j++) {
-                add_edge(idxs[i], idxs[j]);
+        for (uint16_t i = 0; i < n; i++) {
+            for (uint16_t j = (i + 1); j < n; j++) {
+                connect(i, j, 0);
             }
         }
     } break;
 
     // Star topology
     case type::STAR: {
-        for (uint16_t i = 1; i < idxs.size(); i++) {
-            add_edge(idxs[0], idxs[i]);
+        for (uint16_t i = 1; i < n; i++) {
+            connect(0, i, 0);
+        }
+    } break;
+
+    // 2D grid and torus topologies
+    case type::GRID:
+    case type::TORUS: {
+        const uint16_t width = ((params.grid_width != 0) ? params.grid_width :
+            std::max<uint16_t>(1, static_cast<uint16_t>(std::sqrt(n))));
+        const uint16_t height = ((n + width - 1) / width);
+        const bool wrap = (t == type::TORUS);
+        assert(!wrap || ((n % width) == 0)); // Partial row
+
+        for (uint16_t i = 0; i < n; i++) {
+            const uint16_t col = (i % width);
+            if (((col + 1) < width) && ((i + 1) < n)) { connect(i, (i + 1), 0); }
+            else if (wrap && (width > 2)) { connect(i, (i + 1 - width), 0); }
+
+            if ((i + width) < n) { connect(i, (i + width), 0); }
+            else if (wrap && (height > 2)) { connect(i, col, 0); }
+        }
+    } break;
+
+    // k-ary fat-tree topology
+    case type::FAT_TREE: {
+        uint16_t k = 2;
+        while (fat_tree_size(k, params.fat_tree_hosts) < n) { k += 2; }
+        assert(fat_tree_size(k, params.fat_tree_hosts) == n); // Invalid size
+
+        const uint16_t half = (k / 2);
+        const uint16_t num_core = (half * half);
+        const uint32_t num_switches = fat_tree_size(k, false);
+        for (uint16_t pod = 0; pod < k; pod++) {
+            const uint16_t base = (num_core + (pod * k));
+            for (uint16_t a = 0; a < half; a++) {
+                // Aggregation switch a connects to core group a
+                for (uint16_t c = 0; c < half; c++) {
+                    connect((a * half + c), (base + a), 0);
+                }
+                // ... and to every edge switch in the pod
+                for (uint16_t e = 0; e < half; e++) {
+                    connect((base + a), (base + half + e), 0);
+                }
+            }
+            if (!params.fat_tree_hosts) { continue; }
+            for (uint16_t e = 0; e < half; e++) {
+                for (uint16_t h = 0; h < half; h++) {
+                    connect((base + half + e), (num_switches +
+                            (((pod * half) + e) * half) + h), 0);
+                }
+            }
+        }
+    } break;
+
+    // Erdos-Renyi G(n, p) topology
+    case type::ERDOS_RENYI: {
+        std::bernoulli_distribution edge_dist(params.edge_probability);
+        for (uint16_t i = 0; i < n; i++) {
+            for (uint16_t j = (i + 1); j < n; j++) {
+                if (edge_dist(rng)) { connect(i, j, 0); }
+            }
+        }
+    } break;
+
+    // Barabasi-Albert (preferential attachment) topology
+    case type::BARABASI_ALBERT: {
+        const uint16_t m = params.edges_per_node;
+        assert((m >= 1) && (m < n)); // Invalid parameters
+
+        // Each vertex appears here once per incident edge
+        std::vector<uint16_t> endpoints;
+        for (uint16_t i = 0; i <= m; i++) {
+            for (uint16_t j = (i + 1); j <= m; j++) {
+                connect(i, j, 0);
+                endpoints.push_back(i);
+                endpoints.push_back(j);
+            }
+        }
+        std::vector<uint16_t> targets;
+        for (uint16_t v = (m + 1); v < n; v++) {
+            targets.clear();
+            std::uniform_int_distribution<size_t> endpoint_dist(
+                0, (endpoints.size() - 1));
+
+            while (targets.size() < m) {
+                const uint16_t u = endpoints[endpoint_dist(rng)];
+                if (std::find(targets.begin(), targets.end(), u) ==
+                    targets.end()) { targets.push_back(u); }
+            }
+            for (const uint16_t u : targets) {
+                connect(u, v, 0);
+                endpoints.push_back(u);
+                endpoints.push_back(v);
+            }
+        }
+    } break;
+
+    // Waxman random geometric topology
+    case type::WAXMAN: {
+        std::uniform_real_distribution<double> coordinate_dist(0, 1);
+        for (uint16_t i = 0; i < n; i++) {
+            const double x = coordinate_dist(rng);
+            coordinates.push_back({x, coordinate_dist(rng)});
+        }
+        for (uint16_t i = 0; i < n; i++) {
+            for (uint16_t j = (i + 1); j < n; j++) {
+                max_distance = std::max(max_distance, distance(i, j));
+            }
+        }
+        if (max_distance == 0) { max_distance = 1; }
+        for (uint16_t i = 0; i < n; i++) {
+            for (uint16_t j = (i + 1); j < n; j++) {
+                const double d = (distance(i, j) / max_distance);
+                if (coordinate_dist(rng) < (params.waxman_alpha *
+                    std::exp(-d / params.waxman_beta))) { connect(i, j, d); }
+            }
         }
     } break;
 
     // Unimplemented topology
     default: { assert(false); } break;
     } // switch
+
+    // Bridge disconnected components of random topologies: connect the
+    // first vertex of every other component to the component containing
+    // vertex 0 (to the closest vertex for WAXMAN, else a random one).
+    if (params.connected && ((t == type::ERDOS_RENYI) ||
+                             (t == type::WAXMAN))) {
+        for (uint16_t i = 1; i < n; i++) {
+            if (components.find(i) == components.find(0)) { continue; }
+
+            std::vector<uint16_t> candidates;
+            for (uint16_t j = 0; j < n; j++) {
+                if (components.find(j) == components.find(0)) {
+                    candidates.push_back(j);
+                }
+            }
+            if (coordinates.empty()) {
+                const uint16_t j = candidates[std::uniform_int_distribution<
+                    size_t>(0, (candidates.size() - 1))(rng)];
+                connect(j, i, 0);
+            }
+            else {
+                const uint16_t j = *std::min_element(
+                    candidates.begin(), candidates.end(),
+                    [&] (const uint16_t a, const uint16_t b) {
+                        return (distance(i, a) < distance(i, b)); });
+                connect(j, i, (distance(i, j) / max_distance));
+            }
+        }
+    }
+}
+
+uint32_t graph::fat_tree_size(const uint16_t k, const bool with_hosts) {
+    const uint32_t kk = k;
+    return (((5 * kk * kk) / 4) + (with_hosts ? ((kk * kk * kk) / 4) : 0));
+}
+
+bool graph::save_edge_list(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file) {
+        std::cerr << "Failed to open edge list '" << path << "'" << std::endl;
+        return false;
+    }
+    file << "# <idx a> <idx b> <cost a->b> <cost b->a>" << std::endl;
+    file << "nodes " << num_nodes << std::endl;
+    for (uint16_t i = 0; i < num_nodes; i++) {
+        if (nodes_[i].mixaddr() != i) {
+            file << "addr " << i << " " << nodes_[i].mixaddr() << std::endl;
+        }
+    }
+    for (uint16_t u = 0; u < num_nodes; u++) {
+        for (size_t i = 0; i < topology_[u].size(); i++) {
+            const uint16_t v = topology_[u][i];
+            if (v < u) { continue; } // Already written
+
+            const auto& v_adj = topology_[v];
+            const size_t j = (std::find(v_adj.begin(), v_adj.end(), u) -
+                              v_adj.begin());
+
+            file << u << " " << v << " " << nodes_[u].link_costs()[i]
+                 << " " << nodes_[v].link_costs()[j] << std::endl;
+        }
+    }
+    return static_cast<bool>(file);
+}
+
+std::unique_ptr<graph> graph::load_edge_list(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "Failed to open edge list '" << path << "'" << std::endl;
+        return nullptr;
+    }
+    std::unique_ptr<graph> g;
+    std::set<std::pair<uint16_t, uint16_t>> edges;
+    size_t line_number = 0;
+    std::string line;
+
+    auto fail = [&] (const std::string& reason) {
+        std::cerr << path << ":" << line_number << ": "
+                  << reason << std::endl;
+        return nullptr;
+    };
+    // Parses a uint16_t-valued token
+    auto parse = [] (std::istringstream& in, uint16_t& value) {
+        long v;
+        if (!(in >> v) || (v < 0) || (v > UINT16_MAX)) { return false; }
+        value = static_cast<uint16_t>(v);
+        return true;
+    };
+    while (std::getline(file, line)) {
+        line_number++;
+        std::istringstream in(line);
+        std::string token;
+        if (!(in >> token) || (token[0] == '#')) { continue; }
+
+        if (token == "nodes") {
+            uint16_t n;
+            if (g) { return fail("duplicate 'nodes' directive"); }
+            if (!parse(in, n) || (n == 0) || !(in >> std::ws).eof()) {
+                return fail("expected 'nodes <N>'");
+            }
+            g.reset(new graph(n));
+        }
+        else if (!g) { return fail("expected 'nodes <N>' first"); }
+        else if (token == "addr") {
+            uint16_t idx, mixaddr;
+            if (!parse(in, idx) || (idx >= g->num_nodes) ||
+                !parse(in, mixaddr) || !(in >> std::ws).eof()) {
+                return fail("expected 'addr <idx> <mixaddr>'");
+            }
+            g->nodes_[idx].set_mixaddr(mixaddr);
+        }
+        else {
+            std::istringstream edge(line);
+            uint16_t u, v, cost_uv = 1, cost_vu;
+            if (!parse(edge, u) || !parse(edge, v)) {
+                return fail("expected '<idx a> <idx b> [cost a->b [cost b->a]]'");
+            }
+            if ((u >= g->num_nodes) || (v >= g->num_nodes)) {
+                return fail("node index out of range");
+            }
+            if (u == v) { return fail("self-loop"); }
+            if (!edges.insert(std::minmax(u, v)).second) {
+                return fail("duplicate edge");
+            }
+            if (!(edge >> std::ws).eof() && !parse(edge, cost_uv)) {
+                return fail("invalid link cost");
+            }
+            cost_vu = cost_uv;
+            if (!(edge >> std::ws).eof() && !parse(edge, cost_vu)) {
+                return fail("invalid link cost");
+            }
+            if (!(edge >> std::ws).eof()) { return fail("trailing tokens"); }
+            g->add_edge(half_edge(u, cost_uv), half_edge(v, cost_vu));
+        }
+    }
+    if (!g) { return fail("missing 'nodes <N>' directive"); }
+
+    // Sanity check: Ensure mixnet addresses are unique
+    std::set<mixnet_address> mixaddrs;
+    for (const auto& v : g->nodes_) {
+        if (!mixaddrs.insert(v.mixaddr()).second) {
+            return fail("duplicate mixnet address " +
+                        std::to_string(v.mixaddr()));
+        }
+    }
+    return g;
 }
 
 } // namespace testing
@@ -13,6 +13,9 @@
 
 #include "mixnet/address.h"
 
+#include <memory>
+#include <stdint.h>
+#include <string>
 #include <vector>
 
 namespace testing {
@@ -104,10 +107,77 @@ public:
     /**
      * Instantiates special graph topologies using a subset of vertices
      * (corresponding to the given index set). If the idx set is empty,
-     * incorporates all graph vertices.
+     * incorporates all graph vertices. Below, N is the idx set's size.
+     *
+     * GRID and TORUS lay the vertices out row-major, grid_width per row
+     * (the last GRID row may be partial; TORUS requires full rows, and
+     * only wraps around dimensions of size > 2). FAT_TREE instantiates a
+     * k-ary fat-tree, where k is inferred from N (see fat_tree_size());
+     * the (k/2)^2 core switches come first, followed by every pod's k/2
+     * aggregation and k/2 edge switches, then (optionally) the hosts.
+     * ERDOS_RENYI adds every possible edge with edge_probability, while
+     * BARABASI_ALBERT grows a scale-free graph from a clique of (m + 1)
+     * vertices, attaching each new vertex to m existing ones with degree-
+     * proportional probability. WAXMAN places vertices uniformly at random
+     * in the unit square, and connects every pair at distance d with
+     * probability alpha * exp(-d / (beta * L)), where L is the largest
+     * distance between any two vertices.
      */
-    enum class type { LINE = 0, RING, STAR, FULL_MESH };
+    enum class type { LINE = 0, RING, STAR, FULL_MESH, GRID, TORUS,
+                      FAT_TREE, ERDOS_RENYI, BARABASI_ALBERT, WAXMAN };
+
+    // Distribution of generated link costs
+    enum class cost_distribution {
+        UNIFORM = 0,                                // Uniform in [min, max]
+        DISTANCE,                                   // Scaled by d / L (WAXMAN
+                                                    // only, else UNIFORM)
+    };
+
+    /**
+     * Generator parameters (each topology only uses the relevant ones).
+     * Random topologies and link costs are drawn from a PRNG seeded with
+     * seed, so the same parameters always yield the same graph.
+     */
+    struct generator_params {
+        uint32_t seed = 1;                          // PRNG seed
+        uint16_t grid_width = 0;                    // GRID/TORUS: Row length
+                                                    // (0: floor(sqrt(N)))
+        bool fat_tree_hosts = false;                // FAT_TREE: Include hosts?
+        double edge_probability = 0.1;              // ERDOS_RENYI: Edge probability
+        uint16_t edges_per_node = 2;                // BARABASI_ALBERT: m
+        double waxman_alpha = 0.4;                  // WAXMAN: Max edge probability
+        double waxman_beta = 0.2;                   // WAXMAN: Edge length scale
+        bool connected = true;                      // ERDOS_RENYI/WAXMAN: Bridge
+                                                    // any disconnected components?
+        cost_distribution costs = (                 // Link cost distribution
+            cost_distribution::UNIFORM);
+        uint16_t min_cost = 1;                      // Smallest link cost
+        uint16_t max_cost = 1;                      // Largest link cost
+        bool symmetric_costs = true;                // Same cost in both directions?
+
+        // Not an aggregate, so index sets don't convert to parameters
+        explicit generator_params(const uint32_t seed=1) : seed(seed) {}
+    };
     void generate_topology(const type t, std::vector<uint16_t> idxs={});
+    void generate_topology(const type t, const generator_params& params,
+                           std::vector<uint16_t> idxs={});
+
+    // Returns the number of vertices in a k-ary fat-tree (for even k)
+    static uint32_t fat_tree_size(const uint16_t k, const bool with_hosts);
+
+    /**
+     * Edge-list files. Blank lines and lines starting with '#' are ignored.
+     * The first directive must be "nodes <N>"; then, "addr <idx> <mixaddr>"
+     * lines optionally override the default (i.e., index) addresses, and
+     * "<idx a> <idx b> [cost a->b [cost b->a]]" lines specify edges (with
+     * a default cost of 1, and symmetric costs if only one is specified).
+     * Only the topology, link costs, and mixnet addresses are saved (the
+     * order of a node's neighbors, i.e., its port numbering, may change).
+     */
+    bool save_edge_list(const std::string& path) const;
+
+    // Returns nullptr (and prints the reason) on failure
+    static std::unique_ptr<graph> load_edge_list(const std::string& path);
 };
 
 // Cleanup
@@ -0,0 +1,256 @@
+/**
+ * Copyright (C) 2023 Carnegie Mellon University
+ *
+ * This file is part of the Mixnet course project developed for
+ * the Computer Networks course (15-441/641) taught at Carnegie
+ * Mellon University.
+ *
+ * No part of the Mixnet project may be copied and/or distributed
+ * without the express permission of the 15-441/641 course staff.
+ */
+#include "graph.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <queue>
+#include <string>
+#include <unistd.h>
+#include <utility>
+
+using namespace testing;
+
+// (a, b) -> (cost a->b, cost b->a), for a < b
+typedef std::map<std::pair<uint16_t, uint16_t>,
+                 std::pair<uint16_t, uint16_t>> edge_map;
+
+static int num_failures = 0;
+
+#define CHECK(cond) do {                                                \
+    if (!(cond)) {                                                      \
+        std::cerr << __FILE__ << ":" << __LINE__                        \
+                  << ": CHECK failed: " #cond << std::endl;             \
+        num_failures++;                                                 \
+    }                                                                   \
+} while (0)
+
+/**
+ * Helper functions.
+ */
+static edge_map get_edges(const graph& g) {
+    edge_map edges;
+    for (uint16_t u = 0; u < g.num_nodes; u++) {
+        const auto& adj = g.topology()[u];
+        for (size_t i = 0; i < adj.size(); i++) {
+            const uint16_t v = adj[i];
+            const uint16_t cost = g.get_node(u).link_costs()[i];
+            if (u < v) { edges[{u, v}].first = cost; }
+            else { edges[{v, u}].second = cost; }
+        }
+    }
+    return edges;
+}
+
+static size_t degree(const graph& g, const uint16_t v) {
+    return g.topology()[v].size();
+}
+
+static bool is_connected(const graph& g) {
+    std::vector<bool> visited(g.num_nodes, false);
+    std::queue<uint16_t> frontier;
+    frontier.push(0); visited[0] = true;
+    size_t num_visited = 1;
+
+    while (!frontier.empty()) {
+        const uint16_t u = frontier.front(); frontier.pop();
+        for (const uint16_t v : g.topology()[u]) {
+            if (!visited[v]) {
+                visited[v] = true; num_visited++;
+                frontier.push(v);
+            }
+        }
+    }
+    return (num_visited == g.num_nodes);
+}
+
+// Writes the given contents to a file, and tries to load it
+static std::unique_ptr<graph> load_string(const std::string& path,
+                                          const std::string& contents) {
+    { std::ofstream file(path); file << contents; }
+    return graph::load_edge_list(path);
+}
+
+/**
+ * Deterministic topologies.
+ */
+static void test_grid() {
+    const uint16_t width = 4, height = 3;
+    graph g(width * height);
+    graph::generator_params params;
+    params.grid_width = width;
+    g.generate_topology(graph::type::GRID, params);
+
+    // 3 rows of 3 horizontal edges, 2 rows of 4 vertical edges
+    CHECK(get_edges(g).size() == 17);
+    for (uint16_t v = 0; v < g.num_nodes; v++) {
+        const uint16_t row = (v / width), col = (v % width);
+        const size_t expected = ((col > 0) + ((col + 1) < width) +
+                                 (row > 0) + ((row + 1) < height));
+        CHECK(degree(g, v) == expected);
+    }
+}
+
+static void test_torus() {
+    graph g(12);
+    graph::generator_params params;
+    params.grid_width = 4;
+    g.generate_topology(graph::type::TORUS, params);
+
+    CHECK(get_edges(g).size() == 24);
+    for (uint16_t v = 0; v < g.num_nodes; v++) { CHECK(degree(g, v) == 4); }
+}
+
+static void test_fat_tree() {
+    const uint16_t k = 4, half = (k / 2);
+    const uint16_t num_core = (half * half);
+    const uint16_t num_switches = graph::fat_tree_size(k, false);
+    CHECK(num_switches == 20);
+    CHECK(graph::fat_tree_size(k, true) == 36);
+
+    for (const bool hosts : {false, true}) {
+        graph g(graph::fat_tree_size(k, hosts));
+        graph::generator_params params;
+        params.fat_tree_hosts = hosts;
+        g.generate_topology(graph::type::FAT_TREE, params);
+
+        // Core-agg and agg-edge links, plus a link per host
+        CHECK(get_edges(g).size() ==
+              ((k * k * k) / 2u) + (hosts ? ((k * k * k) / 4u) : 0));
+
+        for (uint16_t v = 0; v < g.num_nodes; v++) {
+            if (v < num_core) { CHECK(degree(g, v) == k); }
+            else if (v >= num_switches) { CHECK(degree(g, v) == 1); }
+            else if (((v - num_core) % k) < half) { CHECK(degree(g, v) == k); }
+            else { CHECK(degree(g, v) == (hosts ? k : half)); }
+        }
+        CHECK(is_connected(g));
+    }
+}
+
+static void test_barabasi_albert() {
+    const uint16_t n = 30, m = 2;
+    graph g(n);
+    graph::generator_params params(7);
+    params.edges_per_node = m;
+    g.generate_topology(graph::type::BARABASI_ALBERT, params);
+
+    // Initial (m + 1)-clique, then m edges per additional vertex
+    CHECK(get_edges(g).size() == (((m * (m + 1)) / 2u) + ((n - m - 1) * m)));
+    for (uint16_t v = 0; v < n; v++) { CHECK(degree(g, v) >= m); }
+    CHECK(is_connected(g));
+}
+
+/**
+ * Random topologies.
+ */
+static void test_seeded(const graph::type t) {
+    const uint16_t n = 40;
+    auto generate = [&] (const uint32_t seed) {
+        std::unique_ptr<graph> g(new graph(n));
+        graph::generator_params params(seed);
+        params.min_cost = 1; params.max_cost = 10;
+        params.symmetric_costs = false;
+        g->generate_topology(t, params);
+        return g;
+    };
+    auto a = generate(42), b = generate(42), c = generate(43);
+    const auto edges = get_edges(*a);
+
+    // The same seed yields the same graph (and link costs)
+    CHECK(edges == get_edges(*b));
+    CHECK(edges != get_edges(*c));
+    CHECK(is_connected(*a));
+    CHECK(is_connected(*c));
+
+    for (const auto& [e, costs] : edges) {
+        CHECK((costs.first >= 1) && (costs.first <= 10));
+        CHECK((costs.second >= 1) && (costs.second <= 10));
+    }
+}
+
+/**
+ * Edge-list files.
+ */
+static void test_round_trip(const std::string& path) {
+    graph g(25);
+    graph::generator_params params(3);
+    params.min_cost = 1; params.max_cost = 20;
+    params.symmetric_costs = false;
+    g.generate_topology(graph::type::WAXMAN, params);
+    for (uint16_t v = 0; v < g.num_nodes; v++) {
+        g.get_node(v).set_mixaddr(1000 + (v * 7));
+    }
+    CHECK(g.save_edge_list(path));
+
+    auto loaded = graph::load_edge_list(path);
+    CHECK(loaded != nullptr);
+    if (!loaded) { return; }
+
+    CHECK(loaded->num_nodes == g.num_nodes);
+    CHECK(get_edges(*loaded) == get_edges(g));
+    for (uint16_t v = 0; v < g.num_nodes; v++) {
+        CHECK(loaded->get_node(v).mixaddr() == g.get_node(v).mixaddr());
+    }
+}
+
+static void test_load(const std::string& path) {
+    // Well-formed
+    auto g = load_string(path, "# Comment\n\nnodes 3\naddr 2 9\n"
+                               "0 1\n1 2 5\n0 2 3 4\n");
+    CHECK(g != nullptr);
+    if (g) {
+        const edge_map expected{{{0, 1}, {1, 1}}, {{1, 2}, {5, 5}},
+                                {{0, 2}, {3, 4}}};
+        CHECK(get_edges(*g) == expected);
+        CHECK(g->get_node(2).mixaddr() == 9);
+    }
+
+    // Malformed
+    for (const std::string contents : {
+            "0 1\n",                        // Missing 'nodes'
+            "nodes 0\n",                    // Empty graph
+            "nodes 5abc\n",                 // Trailing characters
+            "nodes 5 6\n",                  // Trailing tokens
+            "nodes 3\nnodes 3\n",           // Duplicate 'nodes'
+            "nodes 3\naddr 1 7 junk\n",     // Trailing tokens
+            "nodes 3\naddr 3 2\n",          // Index out of range
+            "nodes 3\naddr 1 2\n",          // Duplicate mixaddr
+            "nodes 3\n0 3\n",               // Index out of range
+            "nodes 3\n1 1\n",               // Self-loop
+            "nodes 3\n0 1\n1 0\n",          // Duplicate edge
+            "nodes 3\n0 1 70000\n",         // Cost out of range
+            "nodes 3\n0 1 1 1 1\n",         // Trailing tokens
+        }) {
+        CHECK(load_string(path, contents) == nullptr);
+    }
+}
+
+int main() {
+    const std::string path = (std::filesystem::temp_directory_path() /
+        ("graph_test." + std::to_string(getpid()) + ".txt")).string();
+
+    test_grid();
+    test_torus();
+    test_fat_tree();
+    test_barabasi_albert();
+    test_seeded(graph::type::ERDOS_RENYI);
+    test_seeded(graph::type::WAXMAN);
+    test_round_trip(path);
+    test_load(path);
+    std::filesystem::remove(path);
+
+    std::cout << (num_failures ? "FAIL" : "PASS") << " graph_test ("
+              << num_failures << " failures)" << std::endl;
+    return (num_failures ? 1 : 0);
+}
@@ -0,0 +1,19 @@
+/**
+ * Copyright (C) 2023 Carnegie Mellon University
+ *
+ * This file is part of the Mixnet course project developed for
+ * the Computer Networks course (15-441/641) taught at Carnegie
+ * Mellon University.
+ *
+ * No part of the Mixnet project may be copied and/or distributed
+ * without the express permission of the 15-441/641 course staff.
+ */
+#include "testcase.h"
+
+/**
+ * Entry-point for suite builds, linked together with every testcase
+ * in a directory (each of which registers itself via TESTCASE_MAIN).
+ */
+int main(int argc, char **argv) {
+    return testing::testcase::run_suite(TESTING_SUITE, argc, argv);
+}
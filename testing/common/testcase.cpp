@@ -14,6 +14,7 @@
 #include "framework/orchestrator.h"
 #include "external/argparse/argparse.hpp"
 
+#include <algorithm>
 #include <chrono>
 #include <iostream>
 #include <filesystem>
@@ -27,24 +28,158 @@ void testcase::init_graph(const uint16_t num_nodes) {
     graph_ = std::make_unique<graph>(num_nodes);
 }
 
-int testcase::run_testcase(testcase& tc, int argc, char **argv) {
-    argparse::ArgumentParser program(tc.name);
+// Harness configuration (parsed from the command-line)
+struct harness_config {
+    bool autotest = false;                      // Use autotest mode?
+    std::string bin_dir{};                      // Fragment executable path
+    framework::orchestrator::options options{}; // Orchestrator options
+};
+
+// Returns the registered testcase factories (see TESTCASE_MAIN)
+static std::vector<testcase::factory>& registry() {
+    static std::vector<testcase::factory> factories;
+    return factories;
+}
+
+// Parses the harness arguments (along with any that the caller already
+// registered with the program). If force_autotest is set, autotest mode
+// is implied (regardless of whether -a is specified).
+static bool parse_args(argparse::ArgumentParser& program, int argc,
+                       char **argv, harness_config& config,
+                       const bool force_autotest=false) {
     program.add_argument("-a")
            .default_value(false)
            .implicit_value(true)
            .help("Use autotest mode");
+    program.add_argument("--ctrl-port")
+           .default_value(-1)
+           .scan<'i', int>()
+           .help("Listen for node connections on this port (0: any free "
+                 "port; default: any free port in autotest mode, else 9107)");
+    program.add_argument("--pcap-port")
+           .default_value(-1)
+           .scan<'i', int>()
+           .help("Listen for pcap connections on this port (0: any free "
+                 "port; default: any free port in autotest mode, else 9108)");
+    program.add_argument("--io-uring")
+           .default_value(false)
+           .implicit_value(true)
+           .help("Use io_uring for Mixnet link I/O");
+    program.add_argument("--io-threads")
+           .default_value(0)
+           .scan<'i', int>()
+           .help("Perform Mixnet link I/O on N dedicated threads");
+    program.add_argument("--pcap-threads")
+           .default_value(1)
+           .scan<'i', int>()
+           .help("Dispatch pcap callbacks on N threads, sharded by "
+                 "fragment (the testcase's callback must be thread-safe)");
+    program.add_argument("--latency")
+           .default_value(false)
+           .implicit_value(true)
+           .help("Report one-way latencies of injected packets "
+                 "delivered at subscribed nodes");
+    program.add_argument("--pcapng")
+           .default_value(std::string())
+           .help("Write per-node pcapng captures to this directory "
+                 "(requires autotest mode)");
+    program.add_argument("--pcapng-links")
+           .default_value(false)
+           .implicit_value(true)
+           .help("Also capture link-level traffic in the pcapng files");
+    program.add_argument("--local-links")
+           .default_value(false)
+           .implicit_value(true)
+           .help("Use AF_UNIX (SOCK_SEQPACKET) Mixnet links "
+                 "(requires autotest mode)");
+    program.add_argument("--zygote")
+           .default_value(false)
+           .implicit_value(true)
+           .help("Fork node processes from a pre-initialized zygote "
+                 "(requires autotest mode)");
     try {
         program.parse_args(argc, argv);
     }
     catch (const std::runtime_error& err) {
         std::cerr << err.what() << std::endl;
-        return 1;
+        return false;
     }
     // Parse arguments
-    const bool autotest = (program["-a"] == true);
+    const bool autotest = (force_autotest || (program["-a"] == true));
+    const bool io_uring = (program["--io-uring"] == true);
+    const bool local_links = (program["--local-links"] == true);
+    const bool zygote = (program["--zygote"] == true);
+    const int io_threads = program.get<int>("--io-threads");
+    const int pcap_threads = program.get<int>("--pcap-threads");
+    const int ctrl_port = program.get<int>("--ctrl-port");
+    const int pcap_port = program.get<int>("--pcap-port");
+    const auto pcapng_dir = program.get("--pcapng");
+    if (io_uring && (io_threads > 0)) {
+        std::cerr << "--io-uring and --io-threads are "
+                  << "mutually exclusive" << std::endl;
+        return false;
+    }
+    if ((ctrl_port > UINT16_MAX) || (pcap_port > UINT16_MAX)) {
+        std::cerr << "--ctrl-port and --pcap-port must be "
+                  << "valid port numbers" << std::endl;
+        return false;
+    }
+    if (pcap_threads < 1) {
+        std::cerr << "--pcap-threads must be positive" << std::endl;
+        return false;
+    }
+    if (local_links && !autotest) {
+        std::cerr << "--local-links requires autotest mode" << std::endl;
+        return false;
+    }
+    if (zygote && !autotest) {
+        std::cerr << "--zygote requires autotest mode" << std::endl;
+        return false;
+    }
     // Assumes that test-cases are built in a separate subdirectory inside bin
-    auto bin_dir = std::filesystem::path(argv[0]).parent_path().parent_path();
+    config.bin_dir = std::filesystem::path(argv[0]).parent_path().parent_path();
+    config.autotest = autotest;
+
+    // Configure the orchestrator
+    auto& options = config.options;
+    options.autotest_mode = autotest;
+
+    // In autotest mode, the orchestrator launches the node processes
+    // itself, so it can listen on any free port. This allows several
+    // testcases to run concurrently on the same host.
+    const uint16_t default_ctrl_port = (autotest ? 0 :
+        framework::orchestrator::PORT_LISTEN_CTRL);
+    const uint16_t default_pcap_port = (autotest ? 0 :
+        framework::orchestrator::PORT_LISTEN_PCAP);
+
+    options.ctrl_port = ((ctrl_port < 0) ? default_ctrl_port :
+                         static_cast<uint16_t>(ctrl_port));
+    options.pcap_port = ((pcap_port < 0) ? default_pcap_port :
+                         static_cast<uint16_t>(pcap_port));
+    options.link_backend = (io_uring ?
+        framework::networking::backend::IO_URING :
+        framework::networking::backend::SOCKET);
+    options.num_pcap_threads = static_cast<uint16_t>(pcap_threads);
+    options.track_latency = (program["--latency"] == true);
+    options.use_zygote = zygote;
+    options.pcapng_dir = pcapng_dir;
+    if (!pcapng_dir.empty()) {
+        std::filesystem::create_directories(pcapng_dir);
+    }
+    options.pcapng_links = (program["--pcapng-links"] == true);
+    if (io_threads > 0) {
+        options.link_backend = framework::networking::backend::IO_THREADS;
+        options.num_io_threads = static_cast<uint16_t>(io_threads);
+    }
+    options.link_transport = (local_links ?
+        framework::networking::transport::UNIX_SEQPACKET :
+        framework::networking::transport::TCP);
+
+    return true;
+}
 
+bool testcase::run_one(testcase& tc, framework::orchestrator&
+                       orchestrator, const bool autotest) {
     // In autotest mode, the node processes all run on
     // localhost, so we use less conservative timers.
     if (autotest) {
@@ -53,14 +188,12 @@ int testcase::run_testcase(testcase& tc, int argc, char **argv) {
         tc.max_convergence_time_ms_ = 500;
         tc.max_propagation_time_ms_ = 500;
     }
-
-    // Configure the orchestrator
-    framework::orchestrator orchestrator;
-    orchestrator.configure(bin_dir, autotest);
     std::cout << "[Testing] Starting " << tc.name << "..." << std::endl;
 
     // Run the testcase
+    tc.orchestrator_ = &orchestrator;
     auto ec = orchestrator.run(tc);
+    tc.orchestrator_ = nullptr;
     const bool pass = (tc.is_pass() &&
                        (ec == framework::error_code::NONE));
     // Output result
@@ -69,9 +202,88 @@ int testcase::run_testcase(testcase& tc, int argc, char **argv) {
               << (pass ? ("PASS " + tc.name) : "FAIL")
               << std::endl;
 
+    return pass;
+}
+
+int testcase::run_testcase(testcase& tc, int argc, char **argv) {
+    harness_config config;
+    argparse::ArgumentParser program(tc.name);
+    if (!parse_args(program, argc, argv, config)) { return 1; }
+
+    framework::orchestrator orchestrator;
+    orchestrator.configure(config.bin_dir, config.options);
+    run_one(tc, orchestrator, config.autotest);
     return 0;
 }
 
+bool testcase::register_testcase(const factory& factory) {
+    registry().push_back(factory);
+    return true;
+}
+
+int testcase::run_suite(const std::string& name, int argc, char **argv) {
+    harness_config config;
+    argparse::ArgumentParser program(name);
+    if (!parse_args(program, argc, argv, config)) { return 1; }
+
+    // Instantiate every testcase, and run the largest topologies
+    // first. Fragments are then only ever shut down (never spawned)
+    // between consecutive testcases.
+    std::vector<std::unique_ptr<testcase>> testcases;
+    std::vector<std::pair<uint16_t, size_t>> order; // (Size, Index)
+    for (const auto& factory : registry()) {
+        auto probe = factory(); probe->setup();
+        order.emplace_back(probe->get_graph().num_nodes, testcases.size());
+        testcases.push_back(factory());
+    }
+    std::stable_sort(order.begin(), order.end(), [] (
+        const std::pair<uint16_t, size_t>& a,
+        const std::pair<uint16_t, size_t>& b) {
+            return (a.first > b.first); });
+
+    config.options.reuse_fragments = true;
+    framework::orchestrator orchestrator;
+    orchestrator.configure(config.bin_dir, config.options);
+
+    size_t num_passed = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (const auto& [size, idx] : order) {
+        num_passed += run_one(*testcases[idx], orchestrator,
+                              config.autotest);
+        std::cout << std::endl;
+    }
+    orchestrator.release_fragments();
+
+    // Output summary
+    const auto elapsed_ms = std::chrono::duration_cast<std::chrono::
+        milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "[Testing] " << name << ": " << num_passed << "/"
+              << testcases.size() << " passed in " << elapsed_ms
+              << " ms" << std::endl;
+    return ((num_passed == testcases.size()) ? 0 : 1);
+}
+
+int testcase::run_benchmark(const std::string& name, int argc, char **argv,
+                            const args_hook& add_args, const driver& driver,
+                            const std::string& latency_tag) {
+    harness_config config;
+    argparse::ArgumentParser program(name);
+    if (add_args) { add_args(program); }
+    if (!parse_args(program, argc, argv, config, true)) { return 1; }
+
+    // Benchmarks typically sweep many configurations
+    config.options.reuse_fragments = true;
+    config.options.track_latency = !latency_tag.empty();
+    config.options.latency_tag = latency_tag;
+    framework::orchestrator orchestrator;
+    orchestrator.configure(config.bin_dir, config.options);
+
+    const int rc = driver(program, orchestrator);
+    orchestrator.release_fragments();
+    return rc;
+}
+
 bool testcase::check_data(
     const mixnet_packet *const packet,
     const std::string& expected) const {
@@ -107,6 +319,11 @@ bool testcase::check_route(
 }
 
 void testcase::await_convergence() const {
+    // Return early once nodes report a converged state
+    if (orchestrator_ != nullptr) {
+        orchestrator_->await_convergence(max_convergence_time_ms_);
+        return;
+    }
     std::this_thread::sleep_for(std::chrono::
         milliseconds(max_convergence_time_ms_));
 }
@@ -13,13 +13,18 @@
 
 #include "graph.h"
 #include "framework/error.h"
+#include "framework/pcap_filter.h"
+#include "framework/traffic_profile.h"
 #include "mixnet/packet.h"
 
 #include <assert.h>
+#include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
-// Forward declaration
+// Forward declarations
+namespace argparse { class ArgumentParser; }
 namespace framework { class orchestrator; }
 
 namespace testing {
@@ -40,14 +45,25 @@ protected:
     std::unique_ptr<graph> graph_{};            // Underlying test graph
     framework::error_code error_ = (            // Running test error code
         framework::error_code::NONE);
+    framework::orchestrator                     // Orchestrator running
+                *orchestrator_ = nullptr;       // this testcase
 
     // Test results
     uint64_t pcap_count_ = 0;                   // RX packet count
+    uint64_t pcap_drop_count_ = 0;              // Captured packets dropped
+    std::vector<framework::traffic_stats>       // Fragment ID -> Traffic
+                    traffic_stats_{};           // generation statistics
 
     // Configuration
     uint32_t root_hello_interval_ms_ = 100;     // Default: 100 ms
     uint32_t reelection_interval_ms_ = 1000;    // Default: 1 second
 
+    // Packet capture configuration
+    uint32_t pcap_queue_depth_ = 128;           // Default: 128 packets
+    uint16_t pcap_block_timeout_ms_ = 100;      // Default: 100 ms
+    framework::pcap_overflow pcap_overflow_ = ( // Default: Node thread fails
+        framework::pcap_overflow::FAIL);
+
     // Testing parameters
     uint32_t max_convergence_time_ms_ = 5000;   // Default: 5 seconds
     uint32_t max_propagation_time_ms_ = 5000;   // Default: 5 seconds
@@ -65,6 +81,9 @@ protected:
     bool check_route(const mixnet_packet_routing_header *const rh,
                      const std::vector<mixnet_address>& expected) const;
 
+    static bool run_one(testcase& tc, framework::orchestrator&
+                        orchestrator, const bool autotest);
+
     DISALLOW_COPY_AND_ASSIGN(testcase);
     explicit testcase(const std::string& name) : name(name) {}
 
@@ -77,19 +96,52 @@ public:
 
     // Accessors
     uint64_t pcap_count() const { return pcap_count_; }
+    uint64_t pcap_drop_count() const { return pcap_drop_count_; }
+    const std::vector<framework::traffic_stats>& traffic_stats() const {
+        return traffic_stats_;
+    }
     bool is_pass() const { return (pass_pcap_ && pass_teardown_); }
     uint32_t root_hello_interval_ms() const { return root_hello_interval_ms_; }
     uint32_t reelection_interval_ms() const { return reelection_interval_ms_; }
+    uint32_t pcap_queue_depth() const { return pcap_queue_depth_; }
+    uint16_t pcap_block_timeout_ms() const { return pcap_block_timeout_ms_; }
+    framework::pcap_overflow pcap_overflow() const { return pcap_overflow_; }
     const graph& get_graph() const { assert(graph_ != nullptr); return *graph_; }
 
     /**
      * Orchestration methods.
      */
-    // Callback invoked when a pcap subscription is triggered.
+    // Callback invoked when a pcap subscription is triggered. Only
+    // invoked for complete packets (see pcap_truncated()).
     virtual void pcap(
         const uint16_t fragment_id,
         const mixnet_packet *const packet) = 0;
 
+    // Callback invoked instead of pcap() for packets truncated by the
+    // subscription filter's snaplen. Only the first caplen bytes are
+    // valid; packet->total_size is the original (larger) size. By
+    // default, truncated packets are ignored.
+    virtual void pcap_truncated(
+        const uint16_t /* fragment_id */,
+        const mixnet_packet *const /* packet */,
+        const uint16_t /* caplen */) {}
+
+    // Invoked at the end of the testcase with the number of captured
+    // packets the given fragment dropped due to capture queue overflow.
+    void pcap_drops(const uint16_t, const uint64_t count) {
+        pcap_drop_count_ += count;
+    }
+
+    // Invoked at the end of the testcase with the given fragment's
+    // traffic generation statistics (see orchestrator::start_traffic).
+    void traffic_report(const uint16_t fragment_id,
+                        const framework::traffic_stats& stats) {
+        if (traffic_stats_.size() <= fragment_id) {
+            traffic_stats_.resize(fragment_id + 1);
+        }
+        traffic_stats_[fragment_id] = stats;
+    }
+
     // Callback invoked at the very beginning of orchestrator::
     // run(). ALL static configuration (e.g., initializing the
     // graph and setting timeouts) must be performed here.
@@ -108,6 +160,38 @@ public:
      * Entry-point for all testcases.
      */
     static int run_testcase(testcase& tc, int argc, char **argv);
+
+    /**
+     * Entry-point for testcase suites. Runs every registered testcase
+     * in a single process, reusing the fragments across testcases.
+     */
+    typedef std::function<std::unique_ptr<testcase>()> factory;
+    static bool register_testcase(const factory& factory);
+    static int run_suite(const std::string& name, int argc, char **argv);
+
+    /**
+     * Entry-point for benchmarks. Parses the harness arguments, along
+     * with any that add_args registers, then passes the parsed program
+     * and an orchestrator (in autotest mode, and reusing fragments
+     * across runs) to the driver, which typically runs a sweep of
+     * testcases via run_benchmark_case(). If latency_tag is non-empty,
+     * the orchestrator tracks the latencies of DATA packets whose
+     * payload starts with it (e.g., probes amid generated load).
+     * Returns the driver's exit code.
+     */
+    typedef std::function<void(argparse::ArgumentParser&)> args_hook;
+    typedef std::function<int(const argparse::ArgumentParser&,
+                              framework::orchestrator&)> driver;
+    static int run_benchmark(const std::string& name, int argc, char **argv,
+                             const args_hook& add_args, const driver& driver,
+                             const std::string& latency_tag="");
+
+    // Runs a single testcase as part of a benchmark. Returns whether
+    // it completed successfully (see testcase::is_pass()).
+    static bool run_benchmark_case(testcase& tc, framework::
+                                   orchestrator& orchestrator) {
+        return run_one(tc, orchestrator, true);
+    }
 };
 
 // Cleanup
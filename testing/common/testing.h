@@ -33,4 +33,20 @@ using namespace framework;
         return error_;                              \
     }
 
+// Testcase entry-point. In suite builds (where TESTING_SUITE
+// names the suite), the testcase is registered with the suite
+// runner (see testcase::run_suite) instead.
+#ifdef TESTING_SUITE
+#define TESTCASE_MAIN(T)                                    \
+    [[maybe_unused]] static const bool registered_##T = (   \
+        testcase::register_testcase([] {                    \
+            return std::unique_ptr<testcase>(new T()); }));
+#else
+#define TESTCASE_MAIN(T)                                    \
+    int main(int argc, char **argv) {                       \
+        T tc; /* Run testcase */                            \
+        return testcase::run_testcase(tc, argc, argv);      \
+    }
+#endif
+
 #endif // TESTING_COMMON_MACROS_H_
@@ -53,7 +53,4 @@ public:
     }
 };
 
-int main(int argc, char **argv) {
-    testcase_full_mesh_easy tc; // Run testcase
-    return testcase::run_testcase(tc, argc, argv);
-}
+TESTCASE_MAIN(testcase_full_mesh_easy)
@@ -57,7 +57,4 @@ public:
     }
 };
 
-int main(int argc, char **argv) {
-    testcase_line_hard tc; // Run testcase
-    return testcase::run_testcase(tc, argc, argv);
-}
+TESTCASE_MAIN(testcase_line_hard)
@@ -75,7 +75,4 @@ public:
     }
 };
 
-int main(int argc, char **argv) {
-    testcase_link_failure_mesh tc; // Run testcase
-    return testcase::run_testcase(tc, argc, argv);
-}
+TESTCASE_MAIN(testcase_link_failure_mesh)
@@ -65,7 +65,4 @@ public:
     }
 };
 
-int main(int argc, char **argv) {
-    testcase_link_failure_root tc; // Run testcase
-    return testcase::run_testcase(tc, argc, argv);
-}
+TESTCASE_MAIN(testcase_link_failure_root)
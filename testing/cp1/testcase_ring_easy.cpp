@@ -54,7 +54,4 @@ public:
     }
 };
 
-int main(int argc, char **argv) {
-    testcase_ring_easy tc; // Run testcase
-    return testcase::run_testcase(tc, argc, argv);
-}
+TESTCASE_MAIN(testcase_ring_easy)
@@ -66,7 +66,4 @@ public:
     }
 };
 
-int main(int argc, char **argv) {
-    testcase_tiebreak_multi tc; // Run testcase
-    return testcase::run_testcase(tc, argc, argv);
-}
+TESTCASE_MAIN(testcase_tiebreak_multi)
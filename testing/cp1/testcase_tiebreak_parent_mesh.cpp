@@ -73,7 +73,4 @@ public:
     }
 };
 
-int main(int argc, char **argv) {
-    testcase_tiebreak_parent_mesh tc; // Run testcase
-    return testcase::run_testcase(tc, argc, argv);
-}
+TESTCASE_MAIN(testcase_tiebreak_parent_mesh)
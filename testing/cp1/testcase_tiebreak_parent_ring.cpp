@@ -66,7 +66,4 @@ public:
     }
 };
 
-int main(int argc, char **argv) {
-    testcase_tiebreak_parent_ring tc; // Run testcase
-    return testcase::run_testcase(tc, argc, argv);
-}
+TESTCASE_MAIN(testcase_tiebreak_parent_ring)
@@ -63,7 +63,4 @@ public:
     }
 };
 
-int main(int argc, char **argv) {
-    testcase_tree_hard tc; // Run testcase
-    return testcase::run_testcase(tc, argc, argv);
-}
+TESTCASE_MAIN(testcase_tree_hard)
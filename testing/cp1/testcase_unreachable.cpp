@@ -64,7 +64,4 @@ public:
     }
 };
 
-int main(int argc, char **argv) {
-    testcase_unreachable tc; // Run testcase
-    return testcase::run_testcase(tc, argc, argv);
-}
+TESTCASE_MAIN(testcase_unreachable)
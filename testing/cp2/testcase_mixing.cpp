@@ -101,7 +101,4 @@ public:
     }
 };
 
-int main(int argc, char **argv) {
-    testcase_mixing tc; // Run testcase
-    return testcase::run_testcase(tc, argc, argv);
-}
+TESTCASE_MAIN(testcase_mixing)
@@ -74,7 +74,4 @@ public:
     }
 };
 
-int main(int argc, char **argv) {
-    testcase_ping tc; // Run testcase
-    return testcase::run_testcase(tc, argc, argv);
-}
+TESTCASE_MAIN(testcase_ping)
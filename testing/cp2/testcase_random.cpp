@@ -85,7 +85,4 @@ public:
     }
 };
 
-int main(int argc, char **argv) {
-    testcase_random tc; // Run testcase
-    return testcase::run_testcase(tc, argc, argv);
-}
+TESTCASE_MAIN(testcase_random)
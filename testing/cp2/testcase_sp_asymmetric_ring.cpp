@@ -83,7 +83,4 @@ public:
     }
 };
 
-int main(int argc, char **argv) {
-    testcase_sp_asymmetric_ring tc; // Run testcase
-    return testcase::run_testcase(tc, argc, argv);
-}
+TESTCASE_MAIN(testcase_sp_asymmetric_ring)
@@ -81,7 +81,4 @@ public:
     }
 };
 
-int main(int argc, char **argv) {
-    testcase_sp_symmetric_mesh tc; // Run testcase
-    return testcase::run_testcase(tc, argc, argv);
-}
+TESTCASE_MAIN(testcase_sp_symmetric_mesh)
@@ -80,7 +80,4 @@ public:
     }
 };
 
-int main(int argc, char **argv) {
-    testcase_sp_uniform_ring tc; // Run testcase
-    return testcase::run_testcase(tc, argc, argv);
-}
+TESTCASE_MAIN(testcase_sp_uniform_ring)
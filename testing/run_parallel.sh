@@ -0,0 +1,86 @@
+#!/bin/bash
+#
+# Runs the autotest testcases concurrently (JOBS at a time; default 1),
+# then prints per-testcase results, timings, and a pass/fail summary.
+# Each testcase's orchestrator listens on auto-allocated ports, so the
+# testcases don't contend for the ctrl/pcap ports. Run this from the
+# build directory (like the per-checkpoint run_tests.sh scripts).
+#
+# Usage: run_parallel.sh [-j JOBS] [cp1|cp2 ...] [-- TESTCASE_ARGS...]
+#
+# Note: Every testcase runs one busy-polling process per node (plus the
+# orchestrator), and its checks rely on timing (e.g., convergence and
+# propagation waits of 500 ms in autotest mode). Oversubscribing the
+# CPUs causes spurious failures, so keep JOBS * (nodes per testcase)
+# within the number of cores (see nproc).
+#
+# Exits with status 1 if any testcase fails (or doesn't report a result).
+
+jobs=1
+suites=()
+while [[ $# -gt 0 ]]; do
+    case "$1" in
+        -j) jobs="$2"; shift 2;;
+        -j*) jobs="${1#-j}"; shift;;
+        --) shift; break;;
+        -h|--help) sed -n '2,18p' "$0" | sed 's/^# \{0,1\}//'; exit 0;;
+        *) suites+=("$1"); shift;;
+    esac
+done
+extra_args=("$@")
+[[ ${#suites[@]} -eq 0 ]] && suites=(cp1 cp2)
+
+if ! [[ "$jobs" =~ ^[1-9][0-9]*$ ]]; then
+    echo "Invalid number of jobs: $jobs" >&2; exit 2
+fi
+tests=()
+for suite in "${suites[@]}"; do
+    if ! compgen -G "./bin/$suite/testcase_*" > /dev/null; then
+        echo "No testcases found in ./bin/$suite" >&2; exit 2
+    fi
+    tests+=(./bin/"$suite"/testcase_*)
+done
+
+log_dir=$(mktemp -d)
+trap 'rm -rf "$log_dir"' EXIT
+
+# Runs one testcase, recording its output and wall-clock time
+run_one() {
+    local test="$1" log="$2"
+    local start=$(date +%s%N)
+    "$test" -a "${extra_args[@]}" > "$log.out" 2>&1
+    echo $(( ($(date +%s%N) - start) / 1000000 )) > "$log.ms"
+}
+
+start=$(date +%s%N)
+for idx in "${!tests[@]}"; do
+    while [[ $(jobs -rp | wc -l) -ge $jobs ]]; do wait -n; done
+    run_one "${tests[$idx]}" "$log_dir/$idx" &
+done
+wait
+elapsed_ms=$(( ($(date +%s%N) - start) / 1000000 ))
+
+# Aggregate the results (in a stable order)
+num_passed=0; total_ms=0; failed=()
+for idx in "${!tests[@]}"; do
+    log="$log_dir/$idx"; test="${tests[$idx]#./bin/}"
+    ms=$(cat "$log.ms"); total_ms=$((total_ms + ms))
+    if grep -q "^\[Testing\] PASS" "$log.out"; then
+        result="PASS"; num_passed=$((num_passed + 1))
+    else
+        result="FAIL"; failed+=("$idx")
+    fi
+    printf "%-4s %-40s %8d ms\n" "$result" "$test" "$ms"
+done
+
+# Show the output of failed testcases
+for idx in "${failed[@]}"; do
+    echo
+    echo "===== ${tests[$idx]#./bin/} ====="
+    cat "$log_dir/$idx.out"
+done
+
+echo
+echo "$num_passed/${#tests[@]} passed in $elapsed_ms ms" \
+     "($total_ms ms serial, $jobs jobs)"
+[[ ${#failed[@]} -eq 0 ]]